@@ -2,6 +2,27 @@
 #include <utility>
 #include <memory>
 #include <ostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <array>
+#include <numeric>
+#include <filesystem>
+#include <limits>
+#include <chrono>
+#include <map>
+#include <set>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <malloc.h>
 
 // --- External Includes ---
 #include "benchmark/benchmark.h"
@@ -9,9 +30,22 @@
 
 // --- Kratos Includes ---
 #include "includes/kernel.h"
+#include "includes/kratos_application.h"
+#include "containers/model.h"
+#include "includes/kratos_parameters.h"
 #include "containers/array_1d.h"
 #include "spatial_containers/spatial_containers.h"
 #include "utilities/parallel_utilities.h"
+#include "utilities/reduction_utilities.h"
+
+// --- Internal Includes ---
+#include "KratosExecutables/PartitionedTree.hpp"
+#include "KratosExecutables/ModelPartIO.hpp"
+#include "KratosExecutables/SpatialIndexCache.hpp"
+#include "KratosExecutables/MortonBatch.hpp"
+#include "KratosExecutables/BucketKDTree.hpp"
+#include "KratosExecutables/SearchResultBuffer.hpp"
+#include "KratosExecutables/PerformanceCounters.hpp"
 
 struct Entity
 {
@@ -55,7 +89,7 @@ void CreatePoints(
 
     Kratos::IndexPartition<std::size_t>(rOutput.size()).for_each([&rOutput, gap, N](const std::size_t Index) {
         const std::size_t i_x = Index / (N * N);
-        const std::size_t i_y = Index / N;
+        const std::size_t i_y = (Index / N) % N;
         const std::size_t i_z = Index % N;
 
         auto new_entity = std::make_shared<Entity>();
@@ -69,6 +103,568 @@ void CreatePoints(
     });
 }
 
+/// @brief Map an integer to a pseudo-random double in [0, 1) (splitmix64).
+/// @details Being stateless, it generates identical point sets regardless of the number of threads.
+double HashToUnit(std::uint64_t Value)
+{
+    Value += 0x9e3779b97f4a7c15ull;
+    Value = (Value ^ (Value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    Value = (Value ^ (Value >> 27)) * 0x94d049bb133111ebull;
+    Value ^= Value >> 31;
+    return (Value >> 11) * 0x1.0p-53;
+}
+
+/// @brief Uniformly distributed random points in the unit cube.
+void CreateRandomPoints(
+    EntityPointVectorType& rOutput,
+    const std::size_t NumberOfPoints)
+{
+    rOutput.resize(NumberOfPoints);
+
+    Kratos::IndexPartition<std::size_t>(rOutput.size()).for_each([&rOutput](const std::size_t Index) {
+        auto new_entity = std::make_shared<Entity>();
+        new_entity->mId = Index + 1;
+        for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+            new_entity->mPosition[i_dim] = HashToUnit(3 * Index + i_dim);
+        }
+        rOutput[Index] = new_entity;
+    });
+}
+
+/// @brief Points in Gaussian clusters of different sizes.
+/// @details Cluster centers are uniformly distributed in [0.2, 0.8]^3 and their standard
+///          deviations range from 0.005 to 0.05. Points are not clipped to the unit cube.
+void CreateClusteredPoints(
+    EntityPointVectorType& rOutput,
+    const std::size_t NumberOfPoints)
+{
+    constexpr std::size_t number_of_clusters = 16;
+    rOutput.resize(NumberOfPoints);
+
+    // Use a different part of the hash sequence than the random distribution.
+    const std::uint64_t seed = 0x5eedull << 40;
+
+    Kratos::IndexPartition<std::size_t>(rOutput.size()).for_each([&rOutput, seed](const std::size_t Index) {
+        const std::uint64_t i_cluster = std::min<std::uint64_t>(HashToUnit(seed + 6 * Index) * number_of_clusters, number_of_clusters - 1);
+        const double deviation = 0.005 + 0.045 * HashToUnit(seed - 4 * i_cluster - 1);
+
+        // Box-Muller transform of two pairs of uniform samples.
+        std::array<double,4> normal;
+        for (std::size_t i_pair = 0; i_pair < 2; ++i_pair) {
+            const double magnitude = std::sqrt(-2.0 * std::log(1.0 - HashToUnit(seed + 6 * Index + 2 * i_pair + 1)));
+            const double angle = 2.0 * M_PI * HashToUnit(seed + 6 * Index + 2 * i_pair + 2);
+            normal[2 * i_pair] = magnitude * std::cos(angle);
+            normal[2 * i_pair + 1] = magnitude * std::sin(angle);
+        }
+
+        auto new_entity = std::make_shared<Entity>();
+        new_entity->mId = Index + 1;
+        for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+            const double center = 0.2 + 0.6 * HashToUnit(seed - 4 * i_cluster - 2 - i_dim);
+            new_entity->mPosition[i_dim] = center + deviation * normal[i_dim];
+        }
+        rOutput[Index] = new_entity;
+    });
+}
+
+/// @brief Lattice graded towards the z = 0 plane, like a boundary layer mesh.
+/// @details Layers follow a hyperbolic tangent stretching, the first layer being roughly
+///          two orders of magnitude thinner than a uniform one.
+void CreateGradedPoints(
+    EntityPointVectorType& rOutput,
+    const std::size_t N)
+{
+    constexpr double stretching = 3.0;
+    const double gap = 1.0 / (N - 1);
+    rOutput.resize(N * N * N);
+
+    Kratos::IndexPartition<std::size_t>(rOutput.size()).for_each([&rOutput, gap, N](const std::size_t Index) {
+        const std::size_t i_x = Index / (N * N);
+        const std::size_t i_y = (Index / N) % N;
+        const std::size_t i_z = Index % N;
+
+        auto new_entity = std::make_shared<Entity>();
+        new_entity->mId = Index + 1;
+        new_entity->mPosition[0] = gap * i_x;
+        new_entity->mPosition[1] = gap * i_y;
+        new_entity->mPosition[2] = 1.0 - std::tanh(stretching * (1.0 - gap * i_z)) / std::tanh(stretching);
+        rOutput[Index] = new_entity;
+    });
+}
+
+/// @brief Uniformly distributed random points on a sphere inscribed in the unit cube.
+/// @details Represents point sets of surface meshes, which leave most of the bounding box empty.
+void CreateSurfacePoints(
+    EntityPointVectorType& rOutput,
+    const std::size_t NumberOfPoints)
+{
+    rOutput.resize(NumberOfPoints);
+    const std::uint64_t seed = 0x5eedull << 48;
+
+    Kratos::IndexPartition<std::size_t>(rOutput.size()).for_each([&rOutput, seed](const std::size_t Index) {
+        const double z = 2.0 * HashToUnit(seed + 2 * Index) - 1.0;
+        const double angle = 2.0 * M_PI * HashToUnit(seed + 2 * Index + 1);
+        const double r = std::sqrt(std::max(0.0, 1.0 - z * z));
+
+        auto new_entity = std::make_shared<Entity>();
+        new_entity->mId = Index + 1;
+        new_entity->mPosition[0] = 0.5 + 0.5 * r * std::cos(angle);
+        new_entity->mPosition[1] = 0.5 + 0.5 * r * std::sin(angle);
+        new_entity->mPosition[2] = 0.5 + 0.5 * z;
+        rOutput[Index] = new_entity;
+    });
+}
+
+/// @brief Read the nodes of a mesh file (any format supported by @ref Kratos::Executables::IOFactory).
+/// @details Coordinates are shifted and uniformly scaled to fit the unit cube, so that search
+///          radii have the same meaning as for the generated distributions.
+void ReadPoints(
+    EntityPointVectorType& rOutput,
+    const std::filesystem::path& rFilePath)
+{
+    Kratos::Model model;
+    Kratos::ModelPart& r_model_part = model.CreateModelPart("points");
+    Kratos::Executables::IOFactory(rFilePath)->Read(r_model_part);
+
+    const auto& r_nodes = r_model_part.Nodes();
+    if (r_nodes.empty()) {
+        throw std::runtime_error("No nodes in " + rFilePath.string());
+    }
+
+    std::array<double,3> lower {1e300, 1e300, 1e300}, upper {-1e300, -1e300, -1e300};
+    for (const auto& r_node : r_nodes) {
+        for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+            lower[i_dim] = std::min(lower[i_dim], r_node.Coordinates()[i_dim]);
+            upper[i_dim] = std::max(upper[i_dim], r_node.Coordinates()[i_dim]);
+        }
+    }
+    const double longest = std::max({upper[0] - lower[0], upper[1] - lower[1], upper[2] - lower[2]});
+    const double scale = 0 < longest ? 1.0 / longest : 1.0;
+
+    rOutput.resize(r_nodes.size());
+    Kratos::IndexPartition<std::size_t>(rOutput.size()).for_each([&rOutput, &r_nodes, &lower, scale](const std::size_t Index) {
+        const auto& r_node = *(r_nodes.begin() + Index);
+        auto new_entity = std::make_shared<Entity>();
+        new_entity->mId = r_node.Id();
+        for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+            new_entity->mPosition[i_dim] = scale * (r_node.Coordinates()[i_dim] - lower[i_dim]);
+        }
+        rOutput[Index] = new_entity;
+    });
+}
+
+/// @brief Distributions with an extension are read from mesh files.
+bool IsPointFile(const std::string& rDistribution)
+{
+    return std::filesystem::path(rDistribution).has_extension();
+}
+
+// =======================================================================
+// ============================== Workloads ==============================
+// =======================================================================
+
+/// @brief Parameters of a single benchmark run.
+struct BenchmarkCase
+{
+    /// Name of the point distribution (see @ref GetPoints).
+    std::string mDistribution;
+
+    /// Requested number of points. Distributions may round it (lattices are cubes),
+    /// and it is 0 for points read from files.
+    std::size_t mNumberOfPoints;
+
+    std::size_t mLeafSize;
+
+    /// Search radius (not squared, regardless of the backend).
+    double mRadius;
+
+    /// Number of neighbours to find in k-nearest-neighbour searches.
+    std::size_t mNumberOfNeighbours;
+
+    /// Storage layout of the points (see @ref NanoFlannLayoutSearch).
+    std::string mLayout;
+
+    /// Spatial search structure (see @ref SpatialSearchBuild).
+    std::string mStructure;
+
+    /// Operations per step of dynamic point sets (see @ref ParseUpdateMix).
+    std::string mUpdateMix;
+
+    /// Number of queries per parallel chunk, or 0 for one chunk per thread (see @ref ThreadScalingSearch).
+    std::size_t mChunkSize;
+
+    /// Memory placement of the queried points (see @ref ThreadScalingSearch).
+    std::string mPlacement;
+
+    /// Order in which queries run (see @ref BatchedRadiusSearch).
+    std::string mQueryOrder;
+
+    /// Leaf distance kernel (see @ref ParseKernel).
+    std::string mKernel;
+
+    /// Number of threads, or 0 to keep the environment's setting.
+    std::size_t mNumberOfThreads;
+};
+
+/// @brief Get the points of a distribution.
+/// @details The most recently generated set is cached, because consecutive benchmarks
+///          usually share their inputs and generation can take longer than the benchmark.
+std::shared_ptr<const EntityPointVectorType> GetPoints(const BenchmarkCase& rCase)
+{
+    static std::pair<std::string,std::size_t> cached_key;
+    static std::shared_ptr<const EntityPointVectorType> p_cached_points;
+
+    const auto key = std::make_pair(rCase.mDistribution, rCase.mNumberOfPoints);
+    if (p_cached_points && cached_key == key) {
+        return p_cached_points;
+    }
+    p_cached_points.reset();
+
+    auto p_points = std::make_shared<EntityPointVectorType>();
+    const std::size_t n = std::max<std::size_t>(2, std::llround(std::cbrt(static_cast<double>(rCase.mNumberOfPoints))));
+    if (IsPointFile(rCase.mDistribution)) {
+        ReadPoints(*p_points, rCase.mDistribution);
+    } else if (rCase.mDistribution == "lattice") {
+        CreatePoints(*p_points, n);
+    } else if (rCase.mDistribution == "random") {
+        CreateRandomPoints(*p_points, rCase.mNumberOfPoints);
+    } else if (rCase.mDistribution == "clustered") {
+        CreateClusteredPoints(*p_points, rCase.mNumberOfPoints);
+    } else if (rCase.mDistribution == "graded") {
+        CreateGradedPoints(*p_points, n);
+    } else if (rCase.mDistribution == "surface") {
+        CreateSurfacePoints(*p_points, rCase.mNumberOfPoints);
+    } else {
+        throw std::invalid_argument("Unknown point distribution: " + rCase.mDistribution);
+    }
+
+    cached_key = key;
+    p_cached_points = p_points;
+    return p_points;
+}
+
+/// @brief Estimate the radius of a ball that contains a given number of points on average.
+/// @details Assumes the points are uniformly distributed in their bounding box.
+double EstimateRadius(
+    const EntityPointVectorType& rPoints,
+    const std::size_t NumberOfNeighbours)
+{
+    std::array<double,3> lower {1e300, 1e300, 1e300}, upper {-1e300, -1e300, -1e300};
+    for (const auto& rp_point : rPoints) {
+        for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+            lower[i_dim] = std::min(lower[i_dim], rp_point->mPosition[i_dim]);
+            upper[i_dim] = std::max(upper[i_dim], rp_point->mPosition[i_dim]);
+        }
+    }
+
+    // Flat point sets have no volume; fall back to the extent of the longest side.
+    const double longest = std::max({upper[0] - lower[0], upper[1] - lower[1], upper[2] - lower[2], 1e-12});
+    double volume = 1.0;
+    for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+        volume *= std::max(upper[i_dim] - lower[i_dim], 1e-3 * longest);
+    }
+
+    const double density = rPoints.size() / volume;
+    return std::cbrt(3.0 * NumberOfNeighbours / (4.0 * M_PI * density));
+}
+
+// --- Performance counters
+/// Hardware counters of the timed loops, if enabled with --perf-counters.
+std::unique_ptr<Kratos::Executables::PerformanceCounters> pPerformanceCounters;
+
+/// Whether the performance counters were started since they were last reported.
+bool IsCountingPerformance = false;
+
+/// @brief Begin measuring hardware counters, right before a timed loop of queries.
+/// @details @ref SetCounters reports the counts per query.
+void StartPerformanceCounters()
+{
+    if (pPerformanceCounters) {
+        pPerformanceCounters->Start();
+        IsCountingPerformance = true;
+    }
+}
+
+/// @brief Report the problem size and query throughput of a benchmark.
+void SetCounters(
+    benchmark::State& rState,
+    const std::size_t NumberOfPoints,
+    const std::size_t NumberOfQueries)
+{
+    rState.counters["points"] = NumberOfPoints;
+    rState.counters["threads"] = Kratos::ParallelUtilities::GetNumThreads();
+    if (NumberOfQueries) {
+        rState.SetItemsProcessed(rState.iterations() * NumberOfQueries);
+        rState.counters["time/query"] = benchmark::Counter(NumberOfQueries, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    }
+
+    if (IsCountingPerformance && NumberOfQueries) {
+        for (const auto& [r_name, value] : pPerformanceCounters->Read()) {
+            rState.counters[r_name + "/query"] = benchmark::Counter(value / NumberOfQueries, benchmark::Counter::kAvgIterations);
+        }
+    }
+    IsCountingPerformance = false;
+}
+
+// --- Allocation counting
+// Global operator new is replaced to count heap allocations and the bytes they hold, so that
+// benchmarks can report allocations per query and the memory footprint of indices. Allocations
+// through malloc (e.g.: by the OpenMP runtime or nanoflann's node pool) are not counted.
+// The replacements are not inlined, which would pair malloc with operator delete in the eyes of
+// the compiler's mismatched new/delete warnings.
+
+/// Number of allocations through operator new since the program started.
+std::atomic<std::uint64_t> NumberOfAllocations {0};
+
+/// Bytes currently held by allocations through operator new, including the allocator's rounding.
+std::atomic<std::int64_t> LiveBytes {0};
+
+/// Maximum of @ref LiveBytes since the last @ref MemoryMeasurement began.
+std::atomic<std::int64_t> PeakLiveBytes {0};
+
+void CountAllocation(void* pMemory) noexcept
+{
+    NumberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+    const std::int64_t size = malloc_usable_size(pMemory);
+    const std::int64_t live_bytes = LiveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    std::int64_t peak_bytes = PeakLiveBytes.load(std::memory_order_relaxed);
+    while (peak_bytes < live_bytes && !PeakLiveBytes.compare_exchange_weak(peak_bytes, live_bytes, std::memory_order_relaxed)) {}
+}
+
+[[gnu::noinline]] void* operator new(std::size_t Size)
+{
+    if (void* p_memory = std::malloc(Size ? Size : 1)) {
+        CountAllocation(p_memory);
+        return p_memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t Size)
+{
+    return ::operator new(Size);
+}
+
+[[gnu::noinline]] void* operator new(std::size_t Size, std::align_val_t Alignment)
+{
+    void* p_memory = nullptr;
+    if (posix_memalign(&p_memory, std::max(static_cast<std::size_t>(Alignment), sizeof(void*)), Size ? Size : 1)) throw std::bad_alloc();
+    CountAllocation(p_memory);
+    return p_memory;
+}
+
+void* operator new[](std::size_t Size, std::align_val_t Alignment)
+{
+    return ::operator new(Size, Alignment);
+}
+
+[[gnu::noinline]] void operator delete(void* pMemory) noexcept
+{
+    if (pMemory) LiveBytes.fetch_sub(malloc_usable_size(pMemory), std::memory_order_relaxed);
+    std::free(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept { ::operator delete(pMemory); }
+
+void operator delete(void* pMemory, std::size_t) noexcept { ::operator delete(pMemory); }
+
+void operator delete[](void* pMemory, std::size_t) noexcept { ::operator delete(pMemory); }
+
+void operator delete(void* pMemory, std::align_val_t) noexcept { ::operator delete(pMemory); }
+
+void operator delete[](void* pMemory, std::align_val_t) noexcept { ::operator delete(pMemory); }
+
+void operator delete(void* pMemory, std::size_t, std::align_val_t) noexcept { ::operator delete(pMemory); }
+
+void operator delete[](void* pMemory, std::size_t, std::align_val_t) noexcept { ::operator delete(pMemory); }
+
+/// @brief Report the average number of allocations per query since @p NumberOfAllocationsBefore.
+/// @details Call with the number of allocations right before the timed loop.
+void SetAllocationCounters(
+    benchmark::State& rState,
+    const std::uint64_t NumberOfAllocationsBefore,
+    const std::size_t NumberOfQueries)
+{
+    const std::uint64_t number_of_allocations = NumberOfAllocations.load(std::memory_order_relaxed) - NumberOfAllocationsBefore;
+    rState.counters["allocations/query"] = benchmark::Counter(
+        static_cast<double>(number_of_allocations) / std::max<std::size_t>(NumberOfQueries, 1),
+        benchmark::Counter::kAvgIterations);
+}
+
+/// @brief Heap memory allocated through operator new since construction.
+/// @details Construction resets the peak of the whole program, so measurements must not overlap.
+///          Construct the index to measure in a scope of its own, outside the timed loop.
+class MemoryMeasurement
+{
+public:
+    MemoryMeasurement() noexcept
+        : mBaseline(LiveBytes.load(std::memory_order_relaxed))
+    {
+        PeakLiveBytes.store(mBaseline, std::memory_order_relaxed);
+    }
+
+    /// @brief Bytes allocated and not released yet since construction.
+    double GetLiveBytes() const noexcept
+    {
+        return static_cast<double>(LiveBytes.load(std::memory_order_relaxed) - mBaseline);
+    }
+
+    /// @brief Maximum of @ref GetLiveBytes since construction (e.g.: including temporaries of a build).
+    double GetPeakBytes() const noexcept
+    {
+        return static_cast<double>(PeakLiveBytes.load(std::memory_order_relaxed) - mBaseline);
+    }
+
+private:
+    std::int64_t mBaseline;
+}; // class MemoryMeasurement
+
+/// @brief Report the heap footprint of a built index and the peak heap usage while building it.
+/// @details Call once per benchmark with an index built outside the timed loop, which keeps the
+///          allocations of the measurement out of the timings.
+void SetMemoryCounters(
+    benchmark::State& rState,
+    const std::size_t NumberOfPoints,
+    const double IndexBytes,
+    const double PeakBytes)
+{
+    rState.counters["index_bytes"] = benchmark::Counter(IndexBytes, benchmark::Counter::kDefaults, benchmark::Counter::OneK::kIs1024);
+    rState.counters["peak_build_bytes"] = benchmark::Counter(PeakBytes, benchmark::Counter::kDefaults, benchmark::Counter::OneK::kIs1024);
+    rState.counters["index_bytes/point"] = IndexBytes / std::max<std::size_t>(NumberOfPoints, 1);
+}
+
+// --- Verification
+// Each search benchmark compares a sample of its queries to a brute-force search before
+// timing, and fails if the results differ. Radius searches into fixed size outputs also
+// fail if any query fills the output, because the results may then be truncated.
+
+/// Capacity of the output of radius searches on Kratos containers.
+constexpr std::size_t MaxNumberOfResults = 10000;
+
+/// Number of queries compared to a brute-force search.
+constexpr std::size_t NumberOfVerifiedQueries = 64;
+
+/// @brief Relative tolerance on squared distances when comparing results.
+/// @details Backends compute distances in different orders, so points on (or, for single
+///          precision coordinates, near) the search sphere may or may not be found.
+template <class TCoordinate>
+constexpr double GetVerificationTolerance()
+{
+    return 64 * std::numeric_limits<TCoordinate>::epsilon();
+}
+
+double GetSquaredDistance(const Entity& rLeft, const Entity& rRight)
+{
+    double output = 0.0;
+    for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+        const double difference = rLeft.mPosition[i_dim] - rRight.mPosition[i_dim];
+        output += difference * difference;
+    }
+    return output;
+}
+
+/// @brief Verify the results of radius searches on a sample of the points.
+/// @param rSearch Functor returning the points within @p Radius of the point with the given index (in any order).
+/// @return Description of the first mismatch, or an empty string if all results are correct.
+template <class TSearch>
+std::string VerifyRadiusSearch(
+    const EntityPointVectorType& rPoints,
+    const double Radius,
+    const double Tolerance,
+    TSearch&& rSearch)
+{
+    const double squared_radius = Radius * Radius;
+    const std::size_t stride = std::max<std::size_t>(1, rPoints.size() / NumberOfVerifiedQueries);
+
+    for (std::size_t i_query = 0; i_query < rPoints.size(); i_query += stride) {
+        const Entity& r_query = *rPoints[i_query];
+        std::vector<const Entity*> results = rSearch(i_query);
+        std::sort(results.begin(), results.end());
+        if (std::adjacent_find(results.begin(), results.end()) != results.end()) {
+            return "duplicate results for point " + std::to_string(r_query.mId);
+        }
+
+        for (const Entity* p_result : results) {
+            if ((1.0 + Tolerance) * squared_radius < GetSquaredDistance(r_query, *p_result)) {
+                return "point " + std::to_string(p_result->mId) + " is outside the radius of point " + std::to_string(r_query.mId);
+            }
+        }
+
+        const std::size_t missing = Kratos::IndexPartition<std::size_t>(rPoints.size()).for_each<Kratos::SumReduction<std::size_t>>([&](std::size_t Index) -> std::size_t {
+            const Entity* p_point = rPoints[Index].get();
+            return GetSquaredDistance(r_query, *p_point) < (1.0 - Tolerance) * squared_radius
+                   && !std::binary_search(results.begin(), results.end(), p_point);
+        });
+        if (missing) {
+            return std::to_string(missing) + " points within the radius of point " + std::to_string(r_query.mId) + " were not found";
+        }
+    }
+
+    return "";
+}
+
+/// @brief Verify the results of k-nearest-neighbour searches on a sample of the points.
+/// @details Ties make the neighbours ambiguous, so only their distances are compared.
+/// @param rSearch Functor returning the nearest neighbours of the point with the given index (in any order).
+/// @return Description of the first mismatch, or an empty string if all results are correct.
+template <class TSearch>
+std::string VerifyKNNSearch(
+    const EntityPointVectorType& rPoints,
+    const std::size_t NumberOfNeighbours,
+    const double Tolerance,
+    TSearch&& rSearch)
+{
+    const std::size_t k = std::min(NumberOfNeighbours, rPoints.size());
+    const std::size_t stride = std::max<std::size_t>(1, rPoints.size() / NumberOfVerifiedQueries);
+    std::vector<double> reference(rPoints.size());
+
+    for (std::size_t i_query = 0; i_query < rPoints.size(); i_query += stride) {
+        const Entity& r_query = *rPoints[i_query];
+        const std::vector<const Entity*> results = rSearch(i_query);
+        if (results.size() != k) {
+            return "found " + std::to_string(results.size()) + " neighbours of point " + std::to_string(r_query.mId) + " instead of " + std::to_string(k);
+        }
+
+        std::vector<double> distances(k);
+        std::transform(results.begin(), results.end(), distances.begin(), [&r_query](const Entity* pResult) {
+            return GetSquaredDistance(r_query, *pResult);
+        });
+        std::sort(distances.begin(), distances.end());
+
+        Kratos::IndexPartition<std::size_t>(rPoints.size()).for_each([&](std::size_t Index) {
+            reference[Index] = GetSquaredDistance(r_query, *rPoints[Index]);
+        });
+        std::partial_sort(reference.begin(), reference.begin() + k, reference.end());
+
+        for (std::size_t i_neighbour = 0; i_neighbour < k; ++i_neighbour) {
+            if (Tolerance * std::max(reference[i_neighbour], 1e-300) < std::abs(distances[i_neighbour] - reference[i_neighbour])) {
+                return "neighbour " + std::to_string(i_neighbour + 1) + " of point " + std::to_string(r_query.mId) + " is not among the nearest";
+            }
+        }
+    }
+
+    return "";
+}
+
+/// @brief Fail the benchmark if a verification returned an error.
+/// @return True if the benchmark may run.
+bool CheckVerification(benchmark::State& rState, const std::string& rError)
+{
+    if (!rError.empty()) {
+        rState.SkipWithError(("Verification failed: " + rError).c_str());
+        return false;
+    }
+    return true;
+}
+
+/// @brief Fail the benchmark if any radius search filled its output.
+void CheckTruncation(benchmark::State& rState, const std::size_t MaxNumberOfFoundResults)
+{
+    if (MaxNumberOfResults <= MaxNumberOfFoundResults) {
+        rState.SkipWithError(("Radius search results truncated at " + std::to_string(MaxNumberOfResults) + " points").c_str());
+    }
+}
+
 // =======================================================================
 // ============================== NanoFlann ==============================
 // =======================================================================
@@ -92,120 +688,1887 @@ using NanoFlannResultVectorType = std::vector<NanoFlannResultType>;
 using NanoFlannDistanceMetricType = typename nanoflann::metric_L2_Simple::traits<double, NanoFlannEntityAdapter>::distance_t;
 using NanoFlannKDTreeIndexType = nanoflann::KDTreeSingleIndexAdaptor<NanoFlannDistanceMetricType, NanoFlannEntityAdapter, 3>;
 
-void NanoFlannKDTreeBuild(benchmark::State& rState)
+/// @brief Index parameters for a benchmark case.
+/// @details The index is built with as many threads as the benchmark runs on.
+nanoflann::KDTreeSingleIndexAdaptorParams GetNanoFlannParameters(const BenchmarkCase& rCase)
+{
+    return nanoflann::KDTreeSingleIndexAdaptorParams(
+        rCase.mLeafSize,
+        nanoflann::KDTreeSingleIndexAdaptorFlags::None,
+        Kratos::ParallelUtilities::GetNumThreads());
+}
+
+/// @brief Radius search functor for @ref VerifyRadiusSearch on any nanoflann index over @p rPoints.
+/// @details Query coordinates are read from the index' dataset, in the index' coordinate type.
+template <class TIndex>
+auto GetNanoFlannRadiusSearch(const TIndex& rIndex, const EntityPointVectorType& rPoints, const double Radius)
+{
+    using Coordinate = typename TIndex::ElementType;
+    using Distance = typename TIndex::DistanceType;
+
+    // nanoflann's L2 metrics work with squared distances.
+    const Distance squared_radius = Radius * Radius;
+    return [&rIndex, &rPoints, squared_radius](std::size_t Index) {
+        Coordinate query[3];
+        for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) query[i_dim] = rIndex.dataset_.kdtree_get_pt(Index, i_dim);
+        std::vector<nanoflann::ResultItem<typename TIndex::IndexType, Distance>> results;
+        rIndex.radiusSearch(query, squared_radius, results, nanoflann::SearchParameters());
+        std::vector<const Entity*> output;
+        for (const auto& r_result : results) output.push_back(rPoints[r_result.first].get());
+        return output;
+    };
+}
+
+/// @brief Bytes of nanoflann's node pool, which allocates through malloc and escapes @ref MemoryMeasurement.
+double GetNanoFlannPoolBytes(const NanoFlannKDTreeIndexType& rIndex)
+{
+    return static_cast<double>(rIndex.pool_.usedMemory + rIndex.pool_.wastedMemory);
+}
+
+void NanoFlannKDTreeBuild(benchmark::State& rState, const BenchmarkCase& rCase)
 {
-    const std::size_t leaf_size = 10;
-    EntityPointVectorType points;
-    const std::size_t input_size = rState.range(0);
-    CreatePoints(points, input_size);
+    const auto p_points = GetPoints(rCase);
+    const auto& points = *p_points;
 
     NanoFlannEntityAdapter adapter(points);
-    NanoFlannKDTreeIndexType index(3, adapter, nanoflann::KDTreeSingleIndexAdaptorParams(leaf_size, nanoflann::KDTreeSingleIndexAdaptorFlags::None, 0));
+    double index_bytes = 0.0, peak_bytes = 0.0;
+    {
+        // The pool only grows during a build, so adding it to the peak gives an upper bound.
+        const MemoryMeasurement measurement;
+        NanoFlannKDTreeIndexType index(3, adapter, GetNanoFlannParameters(rCase));
+        index_bytes = measurement.GetLiveBytes() + GetNanoFlannPoolBytes(index);
+        peak_bytes = measurement.GetPeakBytes() + GetNanoFlannPoolBytes(index);
+    }
+
+    NanoFlannKDTreeIndexType index(3, adapter, GetNanoFlannParameters(rCase));
 
     for (auto _ : rState) {
         index.buildIndex();
-
-        rState.PauseTiming();
-        NanoFlannResultVectorType result;
-        index.radiusSearch(points.front()->mPosition.data().begin(), 0.5 * 0.5, result, nanoflann::SearchParameters());
-        rState.ResumeTiming();
+        benchmark::ClobberMemory();
     }
+
+    SetCounters(rState, points.size(), 0);
+    SetMemoryCounters(rState, points.size(), index_bytes, peak_bytes);
 }
 
-void NanoFlannKDTreeSearch(benchmark::State& rState)
+void NanoFlannKDTreeSearch(benchmark::State& rState, const BenchmarkCase& rCase)
 {
-    const std::size_t leaf_size = 10;
-    const std::size_t input_size = rState.range(0);
-    EntityPointVectorType points;
-    CreatePoints(points, input_size);
+    const auto p_points = GetPoints(rCase);
+    const auto& points = *p_points;
     NanoFlannEntityAdapter adapter(points);
-    NanoFlannKDTreeIndexType index(3, adapter, nanoflann::KDTreeSingleIndexAdaptorParams(leaf_size, nanoflann::KDTreeSingleIndexAdaptorFlags::None, 0));
+    NanoFlannKDTreeIndexType index(3, adapter, GetNanoFlannParameters(rCase));
     index.buildIndex();
 
+    // nanoflann's L2 metrics work with squared distances.
+    const double squared_radius = rCase.mRadius * rCase.mRadius;
+
+    if (!CheckVerification(rState, VerifyRadiusSearch(points, rCase.mRadius, GetVerificationTolerance<double>(), GetNanoFlannRadiusSearch(index, points, rCase.mRadius)))) return;
+
+    const std::uint64_t number_of_allocations = NumberOfAllocations.load(std::memory_order_relaxed);
+    StartPerformanceCounters();
     for (auto _ : rState) {
         // now search for everything
-        Kratos::block_for_each(points, NanoFlannResultVectorType(), [&index](const auto& pPoint, auto& rTLS) {
-            index.radiusSearch(pPoint->mPosition.data().begin(), 0.5 * 0.5, rTLS, nanoflann::SearchParameters());
+        Kratos::block_for_each(points, NanoFlannResultVectorType(), [&index, squared_radius](const auto& pPoint, auto& rTLS) {
+            index.radiusSearch(pPoint->mPosition.data().begin(), squared_radius, rTLS, nanoflann::SearchParameters());
         });
 
     }
+
+    SetCounters(rState, points.size(), points.size());
+    SetAllocationCounters(rState, number_of_allocations, points.size());
 }
 
-// ======================================================================
-// ============================ KratosKdTree ============================
-// ======================================================================
+void NanoFlannKDTreeKNNSearch(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    const auto& points = *p_points;
+    NanoFlannEntityAdapter adapter(points);
+    NanoFlannKDTreeIndexType index(3, adapter, GetNanoFlannParameters(rCase));
+    index.buildIndex();
 
-// --- Kratos KD Tree types
-using KratosBucketType = Kratos::Bucket<3, Entity, EntityPointVectorType>;
-using KratosKDTreeType = Kratos::Tree<Kratos::KDTreePartition<KratosBucketType>>;
+    const std::size_t k = rCase.mNumberOfNeighbours;
+    using TLS = std::pair<std::vector<unsigned int>,std::vector<double>>;
 
-struct KratosKDtreeResults
-{
-    explicit KratosKDtreeResults(const std::size_t MaxNumberOfNeighbours)
-    {
-        mNeighbours.resize(MaxNumberOfNeighbours);
-        mDistances.resize(MaxNumberOfNeighbours);
+    const auto search = [&index, &points, k](std::size_t Index) {
+        TLS results {std::vector<unsigned int>(k), std::vector<double>(k)};
+        const std::size_t number_of_results = index.knnSearch(points[Index]->mPosition.data().begin(), k, results.first.data(), results.second.data());
+        std::vector<const Entity*> output;
+        for (std::size_t i_result = 0; i_result < number_of_results; ++i_result) output.push_back(points[results.first[i_result]].get());
+        return output;
+    };
+    if (!CheckVerification(rState, VerifyKNNSearch(points, k, GetVerificationTolerance<double>(), search))) return;
+
+    StartPerformanceCounters();
+    for (auto _ : rState) {
+        Kratos::block_for_each(points, TLS(std::vector<unsigned int>(k), std::vector<double>(k)), [&index, k](const auto& pPoint, TLS& rTLS) {
+            index.knnSearch(pPoint->mPosition.data().begin(), k, rTLS.first.data(), rTLS.second.data());
+        });
     }
 
-    EntityPointVectorType mNeighbours;
-    std::vector<double> mDistances;
-};
+    SetCounters(rState, points.size(), points.size());
+}
 
-void KratosKDTreeBuild(benchmark::State& rState)
+// --- Index cache
+/// @brief Cache of indices built for a case's points.
+/// @details Indices of mesh files are stored next to the mesh, others in the temporary directory.
+Kratos::Executables::SpatialIndexCache GetIndexCache(const BenchmarkCase& rCase)
 {
-    const std::size_t leaf_size = 10;
-    const std::size_t input_size = rState.range(0);
-
-    EntityPointVectorType points;
-    CreatePoints(points, input_size);
-
-    std::unique_ptr<KratosKDTreeType> p_index;
+    if (IsPointFile(rCase.mDistribution)) {
+        const std::filesystem::path mesh_path = rCase.mDistribution;
+        return Kratos::Executables::SpatialIndexCache(mesh_path.parent_path(), mesh_path.filename().string());
+    }
 
-    for (auto _ : rState) {
-        p_index = std::make_unique<KratosKDTreeType>(points.begin(), points.end(), leaf_size);
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "kratos_kd_tree_benchmark";
+    std::filesystem::create_directories(directory);
+    return Kratos::Executables::SpatialIndexCache(directory, rCase.mDistribution);
+}
 
-        rState.PauseTiming();
-        Entity point {0ul, Kratos::array_1d<double,3>{1.0, 1.0, 1.0}};
-        KratosKDtreeResults results(1e4);
-        p_index->SearchInRadius(point, 0.5, results.mNeighbours.begin(), results.mDistances.begin(), 1e4);
-        rState.ResumeTiming();
+/// @brief Identify an index by the coordinates it was built for and the parameters that change its layout.
+std::uint64_t GetIndexKey(const EntityPointVectorType& rPoints, const BenchmarkCase& rCase)
+{
+    Kratos::Executables::CoordinateHash hash;
+    hash.Add(static_cast<std::uint64_t>(NANOFLANN_VERSION));
+    hash.Add(static_cast<std::uint64_t>(sizeof(NanoFlannKDTreeIndexType::Node)));
+    hash.Add(static_cast<std::uint64_t>(rCase.mLeafSize));
+    hash.Add(static_cast<std::uint64_t>(rPoints.size()));
+    for (const auto& rp_point : rPoints) {
+        for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+            hash.Add(rp_point->mPosition[i_dim]);
+        }
     }
-
-    EntityPointVectorType neighbours(10000);
-    std::vector<double> distances(10000);
-    p_index->SearchInRadius(*points.front(), 0.5, neighbours.begin(), distances.begin(), 10000);
+    return hash.Get();
 }
 
-void KratosKDTreeSearch(benchmark::State& rState)
+/// @brief Load nanoflann's index from an index cache.
+/// @details The cache file is written before timing if it does not exist yet. Each iteration
+///          constructs an empty index, maps the file and deserializes the index. Iterations
+///          after the first read the file from the page cache, which is what consecutive jobs
+///          on the same mesh see. Compare with NanoFlannKDTreeBuild.
+void NanoFlannKDTreeLoad(benchmark::State& rState, const BenchmarkCase& rCase)
 {
-    const std::size_t leaf_size = 10;
-    const std::size_t input_size = rState.range(0);
+    const auto p_points = GetPoints(rCase);
+    const auto& points = *p_points;
+    NanoFlannEntityAdapter adapter(points);
 
-    EntityPointVectorType points;
-    CreatePoints(points, input_size);
-    KratosKDTreeType index(points.begin(), points.end(), leaf_size);
+    const auto cache = GetIndexCache(rCase);
+    const std::uint64_t key = GetIndexKey(points, rCase);
 
-    std::vector<Entity::Pointer> search_points(100, points.front());
+    auto parameters = GetNanoFlannParameters(rCase);
+    parameters.flags = nanoflann::KDTreeSingleIndexAdaptorFlags::SkipInitialBuildIndex;
 
-    for (auto _ : rState) {
-        // now search for everything
-        Kratos::block_for_each(points, KratosKDtreeResults(10000), [&index](const auto& pPoint, auto& rTLS) {
-            index.SearchInRadius(*pPoint, 0.5, rTLS.mNeighbours.begin(), rTLS.mDistances.begin(), 10000);
-        });
+    {
+        NanoFlannKDTreeIndexType index(3, adapter, parameters);
+        cache.LoadOrBuild(index, key);
 
+        if (!CheckVerification(rState, VerifyRadiusSearch(points, rCase.mRadius, GetVerificationTolerance<double>(), GetNanoFlannRadiusSearch(index, points, rCase.mRadius)))) return;
     }
-}
 
+    for (auto _ : rState) {
+        NanoFlannKDTreeIndexType index(3, adapter, parameters);
+        if (!cache.Load(key, [&index](std::istream& rStream) {index.loadIndex(rStream);})) {
+            rState.SkipWithError(("Index cache file disappeared: " + cache.GetPath(key).string()).c_str());
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
 
-//BENCHMARK(NanoFlannKDTreeBuild) -> RangeMultiplier(4) -> Range(1, 256);
-//BENCHMARK(NanoFlannKDTreeSearch) -> RangeMultiplier(4) -> Range(1, 256);
+    SetCounters(rState, points.size(), 0);
+    rState.counters["file_bytes"] = std::filesystem::file_size(cache.GetPath(key));
+}
 
-//BENCHMARK(KratosKDTreeBuild) -> RangeMultiplier(4) -> Range(1, 256);
-//BENCHMARK(KratosKDTreeSearch) -> RangeMultiplier(4) -> Range(1, 256);
+// --- Flat storage layouts
+// The entities above are separately allocated and held by shared pointers, so every
+// coordinate access dereferences a pointer. The layouts below store coordinates
+// contiguously to measure how much of the search cost is due to the layout.
 
-BENCHMARK(NanoFlannKDTreeBuild)->Arg(256);
+/// @brief Contiguous array of structures.
+template <class TCoordinate>
+struct NanoFlannAoSAdapter
+{
+    std::size_t kdtree_get_point_count() const { return mData.size(); }
 
-//BENCHMARK(KratosKDTreeBuild)->Arg(256);
-//BENCHMARK(KratosKDTreeSearch)->Arg(256);
+    TCoordinate kdtree_get_pt(const std::size_t idx, int dim) const { return mData[idx][dim]; }
 
-BENCHMARK_MAIN();
\ No newline at end of file
+    template <class BBOX> bool kdtree_get_bbox(BBOX &bb) const { return false; }
+
+    std::vector<std::array<TCoordinate,3>> mData;
+};
+
+/// @brief Structure of arrays.
+struct NanoFlannSoAAdapter
+{
+    std::size_t kdtree_get_point_count() const { return mData[0].size(); }
+
+    double kdtree_get_pt(const std::size_t idx, int dim) const { return mData[dim][idx]; }
+
+    template <class BBOX> bool kdtree_get_bbox(BBOX &bb) const { return false; }
+
+    std::array<std::vector<double>,3> mData;
+};
+
+template <class TCoordinate, class TAdapter>
+void RunNanoFlannLayoutSearch(
+    benchmark::State& rState,
+    const BenchmarkCase& rCase,
+    const TAdapter& rAdapter,
+    const EntityPointVectorType& rPoints,
+    const double BytesPerPoint)
+{
+    using Metric = typename nanoflann::metric_L2_Simple::traits<TCoordinate, TAdapter>::distance_t;
+    using Index = nanoflann::KDTreeSingleIndexAdaptor<Metric, TAdapter, 3>;
+    using Results = std::vector<nanoflann::ResultItem<unsigned int, TCoordinate>>;
+
+    Index index(3, rAdapter, GetNanoFlannParameters(rCase));
+    index.buildIndex();
+
+    const std::size_t number_of_points = rAdapter.kdtree_get_point_count();
+    const TCoordinate squared_radius = rCase.mRadius * rCase.mRadius;
+
+    if (!CheckVerification(rState, VerifyRadiusSearch(rPoints, rCase.mRadius, GetVerificationTolerance<TCoordinate>(), GetNanoFlannRadiusSearch(index, rPoints, rCase.mRadius)))) return;
+
+    StartPerformanceCounters();
+    for (auto _ : rState) {
+        Kratos::IndexPartition<std::size_t>(number_of_points).for_each(Results(), [&index, &rAdapter, squared_radius](std::size_t Index, Results& rTLS) {
+            const TCoordinate query[3] {rAdapter.kdtree_get_pt(Index, 0), rAdapter.kdtree_get_pt(Index, 1), rAdapter.kdtree_get_pt(Index, 2)};
+            index.radiusSearch(query, squared_radius, rTLS, nanoflann::SearchParameters());
+        });
+    }
+
+    SetCounters(rState, number_of_points, number_of_points);
+    rState.counters["bytes/point"] = BytesPerPoint;
+}
+
+/// @brief Radius search on the same points stored in different layouts.
+/// @details Layouts:
+///          - shared_ptr: the separately allocated entities of the other benchmarks.
+///          - aos: contiguous xyz triplets of doubles.
+///          - soa: separate contiguous arrays for x, y and z.
+///          - aos_float: contiguous xyz triplets of floats.
+///          Bytes per point only count the storage of the points, not the index.
+void NanoFlannLayoutSearch(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    const auto& points = *p_points;
+    const std::size_t number_of_points = points.size();
+
+    if (rCase.mLayout == "shared_ptr") {
+        // Pointer + entity + control block of make_shared (two reference counts).
+        const double bytes_per_point = sizeof(Entity::Pointer) + sizeof(Entity) + 2 * sizeof(long);
+        RunNanoFlannLayoutSearch<double>(rState, rCase, NanoFlannEntityAdapter(points), points, bytes_per_point);
+    } else if (rCase.mLayout == "aos") {
+        NanoFlannAoSAdapter<double> adapter {std::vector<std::array<double,3>>(number_of_points)};
+        Kratos::IndexPartition<std::size_t>(number_of_points).for_each([&](std::size_t Index) {
+            for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) adapter.mData[Index][i_dim] = points[Index]->mPosition[i_dim];
+        });
+        RunNanoFlannLayoutSearch<double>(rState, rCase, adapter, points, sizeof(std::array<double,3>));
+    } else if (rCase.mLayout == "soa") {
+        NanoFlannSoAAdapter adapter;
+        for (auto& r_component : adapter.mData) r_component.resize(number_of_points);
+        Kratos::IndexPartition<std::size_t>(number_of_points).for_each([&](std::size_t Index) {
+            for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) adapter.mData[i_dim][Index] = points[Index]->mPosition[i_dim];
+        });
+        RunNanoFlannLayoutSearch<double>(rState, rCase, adapter, points, 3 * sizeof(double));
+    } else if (rCase.mLayout == "aos_float") {
+        NanoFlannAoSAdapter<float> adapter {std::vector<std::array<float,3>>(number_of_points)};
+        Kratos::IndexPartition<std::size_t>(number_of_points).for_each([&](std::size_t Index) {
+            for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) adapter.mData[Index][i_dim] = static_cast<float>(points[Index]->mPosition[i_dim]);
+        });
+        RunNanoFlannLayoutSearch<float>(rState, rCase, adapter, points, sizeof(std::array<float,3>));
+    } else {
+        rState.SkipWithError(("Unknown layout: " + rCase.mLayout).c_str());
+    }
+}
+
+// ======================================================================
+// ============================ KratosKdTree ============================
+// ======================================================================
+
+// --- Kratos KD Tree types
+using KratosBucketType = Kratos::Bucket<3, Entity, EntityPointVectorType>;
+using KratosKDTreeType = Kratos::Tree<Kratos::KDTreePartition<KratosBucketType>>;
+
+struct KratosKDtreeResults
+{
+    explicit KratosKDtreeResults(const std::size_t MaxNumberOfNeighbours)
+    {
+        mNeighbours.resize(MaxNumberOfNeighbours);
+        mDistances.resize(MaxNumberOfNeighbours);
+    }
+
+    EntityPointVectorType mNeighbours;
+    std::vector<double> mDistances;
+};
+
+/// @brief Radius search functor for @ref VerifyRadiusSearch on any Kratos container.
+template <class TContainer>
+auto GetKratosRadiusSearch(TContainer& rIndex, const EntityPointVectorType& rPoints, const double Radius)
+{
+    return [&rIndex, &rPoints, Radius](std::size_t Index) {
+        KratosKDtreeResults results(MaxNumberOfResults);
+        const std::size_t number_of_results = rIndex.SearchInRadius(*rPoints[Index], Radius, results.mNeighbours.begin(), results.mDistances.begin(), MaxNumberOfResults);
+        std::vector<const Entity*> output(number_of_results);
+        std::transform(results.mNeighbours.begin(), results.mNeighbours.begin() + number_of_results, output.begin(), [](const auto& rpResult) {
+            return &*rpResult;
+        });
+        return output;
+    };
+}
+
+/// @brief Construct a Kratos spatial container (trees or bins).
+/// @details The leaf size is passed as bucket size, which bins use to size their cells.
+template <class TContainer>
+void KratosContainerBuild(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+
+    // The containers reorder the points they are constructed from.
+    EntityPointVectorType points = *p_points;
+
+    double index_bytes = 0.0, peak_bytes = 0.0;
+    {
+        const MemoryMeasurement measurement;
+        TContainer index(points.begin(), points.end(), rCase.mLeafSize);
+        index_bytes = measurement.GetLiveBytes();
+        peak_bytes = measurement.GetPeakBytes();
+    }
+
+    for (auto _ : rState) {
+        TContainer index(points.begin(), points.end(), rCase.mLeafSize);
+        benchmark::DoNotOptimize(index);
+    }
+
+    SetCounters(rState, points.size(), 0);
+    SetMemoryCounters(rState, points.size(), index_bytes, peak_bytes);
+}
+
+template <class TContainer>
+void KratosContainerSearch(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    EntityPointVectorType points = *p_points;
+    TContainer index(points.begin(), points.end(), rCase.mLeafSize);
+    const double radius = rCase.mRadius;
+
+    if (!CheckVerification(rState, VerifyRadiusSearch(*p_points, radius, GetVerificationTolerance<double>(), GetKratosRadiusSearch(index, *p_points, radius)))) return;
+
+    std::size_t max_results = 0;
+    const std::uint64_t number_of_allocations = NumberOfAllocations.load(std::memory_order_relaxed);
+    StartPerformanceCounters();
+    for (auto _ : rState) {
+        // now search for everything
+        max_results = Kratos::block_for_each<Kratos::MaxReduction<std::size_t>>(points, KratosKDtreeResults(MaxNumberOfResults), [&index, radius](const auto& pPoint, auto& rTLS) -> std::size_t {
+            return index.SearchInRadius(*pPoint, radius, rTLS.mNeighbours.begin(), rTLS.mDistances.begin(), MaxNumberOfResults);
+        });
+
+    }
+
+    SetCounters(rState, points.size(), points.size());
+    SetAllocationCounters(rState, number_of_allocations, points.size());
+    CheckTruncation(rState, max_results);
+}
+
+void KratosKDTreeNearestPoint(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    EntityPointVectorType points = *p_points;
+    KratosKDTreeType index(points.begin(), points.end(), rCase.mLeafSize);
+
+    const auto search = [&index, &p_points](std::size_t Index) {
+        return std::vector<const Entity*> {index.SearchNearestPoint(*(*p_points)[Index]).get()};
+    };
+    if (!CheckVerification(rState, VerifyKNNSearch(*p_points, 1, GetVerificationTolerance<double>(), search))) return;
+
+    StartPerformanceCounters();
+    for (auto _ : rState) {
+        Kratos::block_for_each(points, [&index](const auto& pPoint) {
+            benchmark::DoNotOptimize(index.SearchNearestPoint(*pPoint));
+        });
+    }
+
+    SetCounters(rState, points.size(), points.size());
+}
+
+/// @brief k-nearest-neighbour search on the Kratos tree, which has no native k-NN query.
+/// @details Each query runs SearchInRadius with a result limit, starting from a radius estimated
+///          from the point density. The radius grows if fewer than k points are found, and shrinks
+///          if the limit was hit (the results may then be missing closer points). The k closest
+///          results are then selected. The number of extra searches is reported as "retries".
+///          Radii may never settle (e.g.: more than limit coincident points), so after a number of
+///          retries the smallest radius that hit the limit is searched without limit instead.
+void KratosKDTreeKNNSearch(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    EntityPointVectorType points = *p_points;
+    KratosKDTreeType index(points.begin(), points.end(), rCase.mLeafSize);
+
+    const std::size_t number_of_points = points.size();
+    const std::size_t k = std::min(rCase.mNumberOfNeighbours, number_of_points);
+    const std::size_t limit = 4 * k + 32;
+    const std::size_t max_retries = 32;
+    const double initial_radius = 1.5 * EstimateRadius(points, k);
+
+    struct TLS
+    {
+        KratosKDtreeResults mResults;
+        std::vector<std::size_t> mOrder;
+    };
+
+    // Find the k nearest points, sorted into the first k items of TLS::mOrder.
+    const auto search = [&index, number_of_points, k, limit, max_retries, initial_radius](const Entity& rPoint, TLS& rTLS) -> std::size_t {
+        double radius = initial_radius;
+        double limit_radius = std::numeric_limits<double>::max();
+        std::size_t number_of_results = 0;
+        std::size_t number_of_retries = 0;
+        while (true) {
+            number_of_results = index.SearchInRadius(rPoint, radius, rTLS.mResults.mNeighbours.begin(), rTLS.mResults.mDistances.begin(), limit);
+            if (number_of_results < k) {
+                radius *= 1.5;
+            } else if (number_of_results == limit) {
+                limit_radius = std::min(limit_radius, radius);
+                radius *= 0.75;
+            } else {
+                break;
+            }
+
+            if (++number_of_retries == max_retries) {
+                // Every point is a potential result, and the buffers of this thread keep their size.
+                rTLS.mResults.mNeighbours.resize(number_of_points);
+                rTLS.mResults.mDistances.resize(number_of_points);
+                number_of_results = index.SearchInRadius(rPoint, limit_radius, rTLS.mResults.mNeighbours.begin(), rTLS.mResults.mDistances.begin(), number_of_points);
+                break;
+            }
+        }
+
+        rTLS.mOrder.resize(number_of_results);
+        std::iota(rTLS.mOrder.begin(), rTLS.mOrder.end(), 0);
+        const auto& r_distances = rTLS.mResults.mDistances;
+        std::partial_sort(rTLS.mOrder.begin(), rTLS.mOrder.begin() + k, rTLS.mOrder.end(), [&r_distances](std::size_t Left, std::size_t Right) {
+            return r_distances[Left] < r_distances[Right];
+        });
+        return number_of_retries;
+    };
+
+    const auto verified_search = [&search, &p_points, k, limit](std::size_t Index) {
+        TLS tls {KratosKDtreeResults(limit), {}};
+        search(*(*p_points)[Index], tls);
+        std::vector<const Entity*> output(k);
+        for (std::size_t i_result = 0; i_result < k; ++i_result) output[i_result] = tls.mResults.mNeighbours[tls.mOrder[i_result]].get();
+        return output;
+    };
+    if (!CheckVerification(rState, VerifyKNNSearch(*p_points, k, GetVerificationTolerance<double>(), verified_search))) return;
+
+    std::size_t retries = 0;
+    StartPerformanceCounters();
+    for (auto _ : rState) {
+        retries = Kratos::block_for_each<Kratos::SumReduction<std::size_t>>(points, TLS {KratosKDtreeResults(limit), {}}, [&search](const auto& pPoint, TLS& rTLS) {
+            const std::size_t number_of_retries = search(*pPoint, rTLS);
+            benchmark::DoNotOptimize(rTLS.mOrder.data());
+            return number_of_retries;
+        });
+    }
+
+    SetCounters(rState, points.size(), points.size());
+    rState.counters["retries"] = benchmark::Counter(static_cast<double>(retries) / points.size());
+}
+
+// --- Kratos KD Tree over contiguous entities
+using EntityRawPointerVectorType = std::vector<Entity*>;
+using KratosContiguousBucketType = Kratos::Bucket<3, Entity, EntityRawPointerVectorType>;
+using KratosContiguousKDTreeType = Kratos::Tree<Kratos::KDTreePartition<KratosContiguousBucketType>>;
+
+/// @brief Radius search on the Kratos tree with entities held by shared pointers or stored contiguously.
+/// @details The Kratos tree only stores pointers, so the contiguous layout ("aos") stores the entities
+///          in a single array and indexes raw pointers to them.
+void KratosKDTreeLayoutSearch(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    const double radius = rCase.mRadius;
+
+    if (rCase.mLayout == "shared_ptr") {
+        EntityPointVectorType points = *p_points;
+        KratosKDTreeType index(points.begin(), points.end(), rCase.mLeafSize);
+        if (!CheckVerification(rState, VerifyRadiusSearch(*p_points, radius, GetVerificationTolerance<double>(), GetKratosRadiusSearch(index, *p_points, radius)))) return;
+
+        std::size_t max_results = 0;
+        StartPerformanceCounters();
+        for (auto _ : rState) {
+            max_results = Kratos::block_for_each<Kratos::MaxReduction<std::size_t>>(points, KratosKDtreeResults(MaxNumberOfResults), [&index, radius](const auto& pPoint, auto& rTLS) -> std::size_t {
+                return index.SearchInRadius(*pPoint, radius, rTLS.mNeighbours.begin(), rTLS.mDistances.begin(), MaxNumberOfResults);
+            });
+        }
+        SetCounters(rState, points.size(), points.size());
+        CheckTruncation(rState, max_results);
+        rState.counters["bytes/point"] = sizeof(Entity::Pointer) + sizeof(Entity) + 2 * sizeof(long);
+    } else if (rCase.mLayout == "aos") {
+        std::vector<Entity> entities(p_points->size());
+        EntityRawPointerVectorType points(entities.size());
+        Kratos::IndexPartition<std::size_t>(entities.size()).for_each([&](std::size_t Index) {
+            entities[Index] = *(*p_points)[Index];
+            points[Index] = &entities[Index];
+        });
+        KratosContiguousKDTreeType index(points.begin(), points.end(), rCase.mLeafSize);
+
+        using Results = std::pair<EntityRawPointerVectorType,std::vector<double>>;
+        const auto search = [&index, &entities, &p_points, radius](std::size_t Index) {
+            Results results {EntityRawPointerVectorType(MaxNumberOfResults), std::vector<double>(MaxNumberOfResults)};
+            const std::size_t number_of_results = index.SearchInRadius(entities[Index], radius, results.first.begin(), results.second.begin(), MaxNumberOfResults);
+            std::vector<const Entity*> output(number_of_results);
+            for (std::size_t i_result = 0; i_result < number_of_results; ++i_result) {
+                output[i_result] = (*p_points)[results.first[i_result] - entities.data()].get();
+            }
+            return output;
+        };
+        if (!CheckVerification(rState, VerifyRadiusSearch(*p_points, radius, GetVerificationTolerance<double>(), search))) return;
+
+        std::size_t max_results = 0;
+        StartPerformanceCounters();
+        for (auto _ : rState) {
+            max_results = Kratos::IndexPartition<std::size_t>(entities.size()).for_each<Kratos::MaxReduction<std::size_t>>(Results(EntityRawPointerVectorType(MaxNumberOfResults), std::vector<double>(MaxNumberOfResults)), [&index, &entities, radius](std::size_t Index, Results& rTLS) -> std::size_t {
+                return index.SearchInRadius(entities[Index], radius, rTLS.first.begin(), rTLS.second.begin(), MaxNumberOfResults);
+            });
+        }
+        SetCounters(rState, entities.size(), entities.size());
+        CheckTruncation(rState, max_results);
+        rState.counters["bytes/point"] = sizeof(Entity*) + sizeof(Entity);
+    } else {
+        rState.SkipWithError(("Unsupported layout: " + rCase.mLayout).c_str());
+    }
+}
+
+// --- Other Kratos spatial containers
+using KratosOCTreeType = Kratos::Tree<Kratos::OCTreePartition<KratosBucketType>>;
+using KratosBinsDynamicType = Kratos::BinsDynamic<3, Entity, EntityPointVectorType>;
+using KratosBinsStaticType = Kratos::Bins<3, Entity, EntityPointVectorType>;
+
+/// @brief Call a benchmark with the container type named by the case's structure.
+/// @details Structures:
+///          - nanoflann: nanoflann's KD tree.
+///          - kd_tree: Kratos::Tree<KDTreePartition<Bucket>>.
+///          - octree: Kratos::Tree<OCTreePartition<Bucket>>.
+///          - bins_dynamic: Kratos::BinsDynamic.
+///          - bins_static: Kratos::Bins.
+template <class TFunctor>
+void DispatchStructure(benchmark::State& rState, const BenchmarkCase& rCase, TFunctor&& rFunctor)
+{
+    if (rCase.mStructure == "kd_tree") {
+        rFunctor(static_cast<KratosKDTreeType*>(nullptr));
+    } else if (rCase.mStructure == "octree") {
+        rFunctor(static_cast<KratosOCTreeType*>(nullptr));
+    } else if (rCase.mStructure == "bins_dynamic") {
+        rFunctor(static_cast<KratosBinsDynamicType*>(nullptr));
+    } else if (rCase.mStructure == "bins_static") {
+        rFunctor(static_cast<KratosBinsStaticType*>(nullptr));
+    } else {
+        rState.SkipWithError(("Unknown structure: " + rCase.mStructure).c_str());
+    }
+}
+
+/// @brief Construct any of the structures listed in @ref DispatchStructure.
+/// @details Swept over structures so that all of them show up next to each other for each workload.
+void SpatialSearchBuild(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    if (rCase.mStructure == "nanoflann") {
+        NanoFlannKDTreeBuild(rState, rCase);
+    } else {
+        DispatchStructure(rState, rCase, [&rState, &rCase](auto* pContainer) {
+            KratosContainerBuild<std::remove_pointer_t<decltype(pContainer)>>(rState, rCase);
+        });
+    }
+}
+
+/// @brief Radius search on any of the structures listed in @ref DispatchStructure.
+void SpatialSearchRadius(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    if (rCase.mStructure == "nanoflann") {
+        NanoFlannKDTreeSearch(rState, rCase);
+    } else {
+        DispatchStructure(rState, rCase, [&rState, &rCase](auto* pContainer) {
+            KratosContainerSearch<std::remove_pointer_t<decltype(pContainer)>>(rState, rCase);
+        });
+    }
+}
+
+// --- Thread scaling
+/// @brief Number of parallel chunks of queries over all points (see @ref BenchmarkCase::mChunkSize).
+std::size_t GetNumberOfChunks(const BenchmarkCase& rCase, const std::size_t NumberOfPoints)
+{
+    const std::size_t number_of_chunks = rCase.mChunkSize
+        ? (NumberOfPoints + rCase.mChunkSize - 1) / rCase.mChunkSize
+        : Kratos::ParallelUtilities::GetNumThreads();
+    return std::max<std::size_t>(1, std::min(number_of_chunks, NumberOfPoints));
+}
+
+/// @brief Run timed radius searches over all points in chunks, and report the parallel efficiency.
+/// @details The efficiency T1 / (p Tp) is relative to the single-threaded run of the same case,
+///          and is only reported if that ran before (i.e.: 1 is the first thread count). Cases
+///          without it are noted on stderr.
+/// @return Largest number of results of a query.
+template <class TTLS, class TQuery>
+std::size_t RunScalingQueries(
+    benchmark::State& rState,
+    const BenchmarkCase& rCase,
+    const std::size_t NumberOfPoints,
+    const TTLS& rTLS,
+    TQuery&& rQuery)
+{
+    const std::size_t number_of_threads = Kratos::ParallelUtilities::GetNumThreads();
+    const std::size_t number_of_chunks = GetNumberOfChunks(rCase, NumberOfPoints);
+
+    std::size_t max_results = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    StartPerformanceCounters();
+    for (auto _ : rState) {
+        max_results = Kratos::IndexPartition<std::size_t>(NumberOfPoints, number_of_chunks).template for_each<Kratos::MaxReduction<std::size_t>>(rTLS, rQuery);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    const double time = elapsed.count() / std::max<benchmark::IterationCount>(rState.iterations(), 1);
+
+    // Single-threaded times of each case, regardless of the thread count.
+    static std::map<std::string,double> serial_times;
+    std::stringstream key;
+    key << rCase.mDistribution << '/' << rCase.mNumberOfPoints << '/' << rCase.mLeafSize << '/' << rCase.mRadius
+        << '/' << rCase.mStructure << '/' << rCase.mChunkSize << '/' << rCase.mPlacement;
+    if (number_of_threads == 1) {
+        serial_times[key.str()] = time;
+    }
+
+    const auto it_serial_time = serial_times.find(key.str());
+    if (it_serial_time != serial_times.end()) {
+        rState.counters["speedup"] = it_serial_time->second / time;
+        rState.counters["efficiency"] = it_serial_time->second / (number_of_threads * time);
+    } else {
+        // Benchmarks run several times to settle their number of iterations, note each case once.
+        static std::set<std::string> noted_cases;
+        if (noted_cases.insert(key.str()).second) {
+            std::cerr << "No single-threaded time of " << key.str() << ", speedup and efficiency are not reported"
+                      << " (1 must be the first of --threads).\n";
+        }
+    }
+    rState.counters["chunks"] = number_of_chunks;
+
+    return max_results;
+}
+
+/// @brief Radius search for strong scaling studies.
+/// @details Queries run over chunks of the requested size (by default one per thread, like
+///          block_for_each), all threads sharing the same index. With "first_touch_points" placement,
+///          the queried entities are copied before timing in the same partition the queries use,
+///          so that each thread allocates and first writes the entities it queries, and their
+///          pages are placed on its NUMA node. "serial" copies them on the main thread instead,
+///          which places all of them on a single node. Only the entities are placed: the index
+///          is constructed on the main thread in both cases, so its own nodes stay on that
+///          thread's NUMA node. Threads are pinned through OpenMP's environment
+///          (e.g.: OMP_PROC_BIND=close OMP_PLACES=cores).
+void ThreadScalingSearch(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    const std::size_t number_of_points = p_points->size();
+    const std::size_t number_of_chunks = GetNumberOfChunks(rCase, number_of_points);
+
+    EntityPointVectorType points(number_of_points);
+    const auto copy = [&points, &p_points](std::size_t Index) {
+        points[Index] = std::make_shared<Entity>(*(*p_points)[Index]);
+    };
+    if (rCase.mPlacement == "first_touch_points") {
+        Kratos::IndexPartition<std::size_t>(number_of_points, number_of_chunks).for_each(copy);
+    } else if (rCase.mPlacement == "serial") {
+        for (std::size_t i_point = 0; i_point < number_of_points; ++i_point) copy(i_point);
+    } else {
+        rState.SkipWithError(("Unknown placement: " + rCase.mPlacement).c_str());
+        return;
+    }
+
+    const double radius = rCase.mRadius;
+    std::size_t max_results = 0;
+
+    if (rCase.mStructure == "nanoflann") {
+        NanoFlannEntityAdapter adapter(points);
+        NanoFlannKDTreeIndexType index(3, adapter, GetNanoFlannParameters(rCase));
+        const double squared_radius = radius * radius;
+        if (!CheckVerification(rState, VerifyRadiusSearch(points, radius, GetVerificationTolerance<double>(), GetNanoFlannRadiusSearch(index, points, radius)))) return;
+
+        RunScalingQueries(rState, rCase, number_of_points, NanoFlannResultVectorType(), [&index, &points, squared_radius](std::size_t Index, NanoFlannResultVectorType& rTLS) {
+            return index.radiusSearch(points[Index]->mPosition.data().begin(), squared_radius, rTLS, nanoflann::SearchParameters());
+        });
+    } else {
+        DispatchStructure(rState, rCase, [&](auto* pContainer) {
+            using Container = std::remove_pointer_t<decltype(pContainer)>;
+
+            // The containers reorder the points they are constructed from.
+            EntityPointVectorType container_points = points;
+            Container index(container_points.begin(), container_points.end(), rCase.mLeafSize);
+            if (!CheckVerification(rState, VerifyRadiusSearch(points, radius, GetVerificationTolerance<double>(), GetKratosRadiusSearch(index, points, radius)))) return;
+
+            max_results = RunScalingQueries(rState, rCase, number_of_points, KratosKDtreeResults(MaxNumberOfResults), [&index, &points, radius](std::size_t Index, KratosKDtreeResults& rTLS) -> std::size_t {
+                return index.SearchInRadius(*points[Index], radius, rTLS.mNeighbours.begin(), rTLS.mDistances.begin(), MaxNumberOfResults);
+            });
+            CheckTruncation(rState, max_results);
+        });
+    }
+
+    SetCounters(rState, number_of_points, number_of_points);
+}
+
+// --- Batched queries
+/// @brief Run timed queries over all points in the requested order (see @ref BatchedRadiusSearch).
+/// @param rQuery Called as rQuery(iQuery, rTLS) with the index of the query point, returns its number of results.
+/// @return Largest number of results of a query.
+template <class TTLS, class TQuery>
+std::size_t RunBatchedQueries(
+    benchmark::State& rState,
+    const BenchmarkCase& rCase,
+    const EntityPointVectorType& rPoints,
+    const TTLS& rTLS,
+    TQuery&& rQuery)
+{
+    const std::size_t number_of_points = rPoints.size();
+    std::size_t max_results = 0;
+    StartPerformanceCounters();
+    for (auto _ : rState) {
+        if (rCase.mQueryOrder == "morton") {
+            const Kratos::Executables::MortonBatch<3> batch(number_of_points, [&rPoints](std::size_t iQuery, std::size_t iDimension) {
+                return (*rPoints[iQuery])[iDimension];
+            });
+            max_results = batch.ForEach<Kratos::MaxReduction<std::size_t>>(rCase.mChunkSize, rTLS, rQuery);
+        } else {
+            max_results = Kratos::IndexPartition<std::size_t>(number_of_points, GetNumberOfChunks(rCase, number_of_points)).template for_each<Kratos::MaxReduction<std::size_t>>(rTLS, rQuery);
+        }
+        benchmark::ClobberMemory();
+    }
+    return max_results;
+}
+
+/// @brief Radius search over all points, in the input order or through @ref Kratos::Executables::MortonBatch.
+/// @details Both orders run in chunks of the requested size, and store the number of results of
+///          each query at its index in the input. Sorting the queries is timed, because batches
+///          of queries generally change between searches.
+void BatchedRadiusSearch(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    if (rCase.mQueryOrder != "input" && rCase.mQueryOrder != "morton") {
+        rState.SkipWithError(("Unknown query order: " + rCase.mQueryOrder).c_str());
+        return;
+    }
+
+    const auto p_points = GetPoints(rCase);
+    const EntityPointVectorType& r_points = *p_points;
+    const std::size_t number_of_points = r_points.size();
+    const double radius = rCase.mRadius;
+    std::vector<std::size_t> result_counts(number_of_points);
+
+    if (rCase.mStructure == "nanoflann") {
+        NanoFlannEntityAdapter adapter(r_points);
+        NanoFlannKDTreeIndexType index(3, adapter, GetNanoFlannParameters(rCase));
+        const double squared_radius = radius * radius;
+        if (!CheckVerification(rState, VerifyRadiusSearch(r_points, radius, GetVerificationTolerance<double>(), GetNanoFlannRadiusSearch(index, r_points, radius)))) return;
+
+        RunBatchedQueries(rState, rCase, r_points, NanoFlannResultVectorType(), [&](std::size_t iQuery, NanoFlannResultVectorType& rTLS) {
+            return result_counts[iQuery] = index.radiusSearch(r_points[iQuery]->mPosition.data().begin(), squared_radius, rTLS, nanoflann::SearchParameters());
+        });
+    } else if (rCase.mStructure == "kd_tree") {
+        // The tree reorders the points it is constructed from.
+        EntityPointVectorType tree_points = r_points;
+        KratosKDTreeType index(tree_points.begin(), tree_points.end(), rCase.mLeafSize);
+        if (!CheckVerification(rState, VerifyRadiusSearch(r_points, radius, GetVerificationTolerance<double>(), GetKratosRadiusSearch(index, r_points, radius)))) return;
+
+        const std::size_t max_results = RunBatchedQueries(rState, rCase, r_points, KratosKDtreeResults(MaxNumberOfResults), [&](std::size_t iQuery, KratosKDtreeResults& rTLS) -> std::size_t {
+            return result_counts[iQuery] = index.SearchInRadius(*r_points[iQuery], radius, rTLS.mNeighbours.begin(), rTLS.mDistances.begin(), MaxNumberOfResults);
+        });
+        CheckTruncation(rState, max_results);
+    } else {
+        rState.SkipWithError(("Unsupported structure: " + rCase.mStructure).c_str());
+        return;
+    }
+
+    SetCounters(rState, number_of_points, number_of_points);
+}
+
+// --- Reusable result buffers
+using NanoFlannResultBufferType = Kratos::Executables::SearchResultBuffer<unsigned int>;
+
+using KratosResultBufferType = Kratos::Executables::SearchResultBuffer<Entity::Pointer>;
+
+/// @brief Run a query for each point in one chunk per buffer, in parallel.
+/// @details Thread local storage of block_for_each copies its prototype at every call,
+///          while these buffers are allocated once before timing, so that timed queries
+///          run without allocating.
+/// @param rQuery Called as rQuery(iQuery, rBuffer), returns the number of results.
+/// @return Largest number of results of a query.
+template <class TBuffer, class TQuery>
+std::size_t ForEachQuery(
+    std::vector<TBuffer>& rBuffers,
+    const std::size_t NumberOfQueries,
+    TQuery&& rQuery)
+{
+    const std::size_t number_of_chunks = rBuffers.size();
+    return Kratos::IndexPartition<std::size_t>(number_of_chunks).for_each<Kratos::MaxReduction<std::size_t>>([&](std::size_t iChunk) {
+        TBuffer& r_buffer = rBuffers[iChunk];
+        std::size_t max_results = 0;
+        const std::size_t i_end = NumberOfQueries * (iChunk + 1) / number_of_chunks;
+        for (std::size_t i_query = NumberOfQueries * iChunk / number_of_chunks; i_query < i_end; ++i_query) {
+            max_results = std::max<std::size_t>(max_results, rQuery(i_query, r_buffer));
+        }
+        return max_results;
+    });
+}
+
+/// @brief Radius search writing into preallocated buffers through nanoflann's result set interface.
+/// @details Unlike @ref NanoFlannKDTreeSearch, results are not sorted.
+void NanoFlannKDTreeBufferSearch(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    const auto& points = *p_points;
+    NanoFlannEntityAdapter adapter(points);
+    NanoFlannKDTreeIndexType index(3, adapter, GetNanoFlannParameters(rCase));
+    const double squared_radius = rCase.mRadius * rCase.mRadius;
+    const nanoflann::SearchParameters parameters(0, false);
+
+    const auto query = [&index, &points, &parameters](std::size_t iQuery, NanoFlannResultBufferType& rBuffer) -> std::size_t {
+        rBuffer.clear();
+        return index.radiusSearchCustomCallback(points[iQuery]->mPosition.data().begin(), rBuffer, parameters);
+    };
+
+    const auto search = [&query, &points, squared_radius](std::size_t Index) {
+        NanoFlannResultBufferType buffer(MaxNumberOfResults, squared_radius);
+        const std::size_t number_of_results = query(Index, buffer);
+        std::vector<const Entity*> output;
+        for (std::size_t i_result = 0; i_result < number_of_results; ++i_result) output.push_back(points[buffer.GetValue(i_result)].get());
+        return output;
+    };
+    if (!CheckVerification(rState, VerifyRadiusSearch(points, rCase.mRadius, GetVerificationTolerance<double>(), search))) return;
+
+    std::vector<NanoFlannResultBufferType> buffers(Kratos::ParallelUtilities::GetNumThreads(), NanoFlannResultBufferType(MaxNumberOfResults, squared_radius));
+    std::size_t max_results = 0;
+    const std::uint64_t number_of_allocations = NumberOfAllocations.load(std::memory_order_relaxed);
+    StartPerformanceCounters();
+    for (auto _ : rState) {
+        max_results = ForEachQuery(buffers, points.size(), query);
+    }
+
+    SetCounters(rState, points.size(), points.size());
+    SetAllocationCounters(rState, number_of_allocations, points.size());
+    CheckTruncation(rState, max_results);
+}
+
+/// @brief Radius search writing into preallocated buffers through Kratos' output iterators.
+void KratosKDTreeBufferSearch(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    EntityPointVectorType points = *p_points;
+    KratosKDTreeType index(points.begin(), points.end(), rCase.mLeafSize);
+    const double radius = rCase.mRadius;
+
+    const auto query = [&index, &points, radius](std::size_t iQuery, KratosResultBufferType& rBuffer) -> std::size_t {
+        rBuffer.SetSize(index.SearchInRadius(*points[iQuery], radius, rBuffer.ValuesBegin(), rBuffer.DistancesBegin(), rBuffer.Capacity()));
+        return rBuffer.size();
+    };
+
+    const auto search = [&query](std::size_t Index) {
+        KratosResultBufferType buffer(MaxNumberOfResults);
+        const std::size_t number_of_results = query(Index, buffer);
+        std::vector<const Entity*> output;
+        for (std::size_t i_result = 0; i_result < number_of_results; ++i_result) output.push_back(buffer.GetValue(i_result).get());
+        return output;
+    };
+    if (!CheckVerification(rState, VerifyRadiusSearch(points, radius, GetVerificationTolerance<double>(), search))) return;
+
+    std::vector<KratosResultBufferType> buffers(Kratos::ParallelUtilities::GetNumThreads(), KratosResultBufferType(MaxNumberOfResults));
+    std::size_t max_results = 0;
+    const std::uint64_t number_of_allocations = NumberOfAllocations.load(std::memory_order_relaxed);
+    StartPerformanceCounters();
+    for (auto _ : rState) {
+        max_results = ForEachQuery(buffers, points.size(), query);
+    }
+
+    SetCounters(rState, points.size(), points.size());
+    SetAllocationCounters(rState, number_of_allocations, points.size());
+    CheckTruncation(rState, max_results);
+}
+
+// --- Kratos KD Tree constructed in parallel
+using KratosPartitionedKDTreeType = Kratos::Executables::PartitionedTree<KratosKDTreeType>;
+
+/// @brief Number of subtrees of a partitioned tree.
+/// @details A few partitions per thread keep the threads busy if subtrees take uneven time.
+std::size_t GetNumberOfPartitions()
+{
+    return 4 * Kratos::ParallelUtilities::GetNumThreads();
+}
+
+void KratosPartitionedKDTreeBuild(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    EntityPointVectorType points = *p_points;
+    std::size_t number_of_partitions = 0;
+
+    double index_bytes = 0.0, peak_bytes = 0.0;
+    {
+        const MemoryMeasurement measurement;
+        KratosPartitionedKDTreeType index(points.begin(), points.end(), rCase.mLeafSize, GetNumberOfPartitions());
+        index_bytes = measurement.GetLiveBytes();
+        peak_bytes = measurement.GetPeakBytes();
+    }
+
+    for (auto _ : rState) {
+        KratosPartitionedKDTreeType index(points.begin(), points.end(), rCase.mLeafSize, GetNumberOfPartitions());
+        number_of_partitions = index.NumberOfPartitions();
+        benchmark::DoNotOptimize(index);
+    }
+
+    SetCounters(rState, points.size(), 0);
+    SetMemoryCounters(rState, points.size(), index_bytes, peak_bytes);
+    rState.counters["partitions"] = number_of_partitions;
+}
+
+void KratosPartitionedKDTreeSearch(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    EntityPointVectorType points = *p_points;
+    KratosPartitionedKDTreeType index(points.begin(), points.end(), rCase.mLeafSize, GetNumberOfPartitions());
+    const double radius = rCase.mRadius;
+
+    if (!CheckVerification(rState, VerifyRadiusSearch(*p_points, radius, GetVerificationTolerance<double>(), GetKratosRadiusSearch(index, *p_points, radius)))) return;
+
+    std::size_t max_results = 0;
+    StartPerformanceCounters();
+    for (auto _ : rState) {
+        max_results = Kratos::block_for_each<Kratos::MaxReduction<std::size_t>>(points, KratosKDtreeResults(MaxNumberOfResults), [&index, radius](const auto& pPoint, auto& rTLS) -> std::size_t {
+            return index.SearchInRadius(*pPoint, radius, rTLS.mNeighbours.begin(), rTLS.mDistances.begin(), MaxNumberOfResults);
+        });
+    }
+
+    SetCounters(rState, points.size(), points.size());
+    CheckTruncation(rState, max_results);
+    rState.counters["partitions"] = index.NumberOfPartitions();
+}
+
+// ======================================================================
+// ======================== SIMD leaf bucket tree =======================
+// ======================================================================
+
+/// @brief Parse the name of a leaf distance kernel (scalar, avx2 or avx512).
+Kratos::Executables::BucketKDTree::Kernel ParseKernel(const std::string& rName)
+{
+    using Kernel = Kratos::Executables::BucketKDTree::Kernel;
+    if (rName == "scalar") return Kernel::Scalar;
+    if (rName == "avx2") return Kernel::AVX2;
+    if (rName == "avx512") return Kernel::AVX512;
+    throw std::invalid_argument("Unknown kernel: " + rName);
+}
+
+Kratos::Executables::BucketKDTree MakeBucketKDTree(const EntityPointVectorType& rPoints, const BenchmarkCase& rCase)
+{
+    return Kratos::Executables::BucketKDTree(
+        rPoints.size(),
+        [&rPoints](std::size_t iPoint, std::size_t iDimension) {return (*rPoints[iPoint])[iDimension];},
+        rCase.mLeafSize,
+        ParseKernel(rCase.mKernel));
+}
+
+struct BucketKDTreeResults
+{
+    explicit BucketKDTreeResults(const std::size_t MaxNumberOfNeighbours)
+        : mIndices(MaxNumberOfNeighbours),
+          mSquaredDistances(MaxNumberOfNeighbours)
+    {
+    }
+
+    std::vector<std::size_t> mIndices;
+    std::vector<double> mSquaredDistances;
+};
+
+void BucketKDTreeBuild(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+
+    double index_bytes = 0.0, peak_bytes = 0.0;
+    {
+        const MemoryMeasurement measurement;
+        const auto index = MakeBucketKDTree(*p_points, rCase);
+        index_bytes = measurement.GetLiveBytes();
+        peak_bytes = measurement.GetPeakBytes();
+    }
+
+    for (auto _ : rState) {
+        const auto index = MakeBucketKDTree(*p_points, rCase);
+        benchmark::DoNotOptimize(index.NumberOfPoints());
+    }
+
+    SetCounters(rState, p_points->size(), 0);
+    SetMemoryCounters(rState, p_points->size(), index_bytes, peak_bytes);
+}
+
+/// @brief Radius search with one of the leaf distance kernels.
+/// @details Compare with @ref NanoFlannKDTreeSearch and the Kratos KD tree over --leaf-sizes,
+///          since wider kernels shift the optimal leaf size upwards.
+void BucketKDTreeSearch(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    const auto& points = *p_points;
+    const auto index = MakeBucketKDTree(points, rCase);
+    const double radius = rCase.mRadius;
+
+    const auto search = [&index, &points, radius](std::size_t Index) {
+        BucketKDTreeResults results(MaxNumberOfResults);
+        const std::size_t number_of_results = index.SearchInRadius(points[Index]->mPosition.data().begin(), radius, results.mIndices.data(), results.mSquaredDistances.data(), MaxNumberOfResults);
+        std::vector<const Entity*> output;
+        for (std::size_t i_result = 0; i_result < number_of_results; ++i_result) output.push_back(points[results.mIndices[i_result]].get());
+        return output;
+    };
+    if (!CheckVerification(rState, VerifyRadiusSearch(points, radius, GetVerificationTolerance<double>(), search))) return;
+
+    std::size_t max_results = 0;
+    const std::uint64_t number_of_allocations = NumberOfAllocations.load(std::memory_order_relaxed);
+    StartPerformanceCounters();
+    for (auto _ : rState) {
+        max_results = Kratos::block_for_each<Kratos::MaxReduction<std::size_t>>(points, BucketKDTreeResults(MaxNumberOfResults), [&index, radius](const auto& pPoint, auto& rTLS) -> std::size_t {
+            return index.SearchInRadius(pPoint->mPosition.data().begin(), radius, rTLS.mIndices.data(), rTLS.mSquaredDistances.data(), MaxNumberOfResults);
+        });
+    }
+
+    SetCounters(rState, points.size(), points.size());
+    SetAllocationCounters(rState, number_of_allocations, points.size());
+    CheckTruncation(rState, max_results);
+}
+
+// ======================================================================
+// ========================== Dynamic point sets ========================
+// ======================================================================
+
+/// @brief Number of operations in a step of a dynamic point set, relative to its number of points.
+struct UpdateMix
+{
+    double mInsert;
+
+    double mRemove;
+
+    double mQuery;
+};
+
+/// @brief Parse an update mix from "insert:remove:query" (e.g.: "0.01:0.01:0.1").
+UpdateMix ParseUpdateMix(const std::string& rMix)
+{
+    std::vector<double> fractions;
+    std::stringstream stream(rMix);
+    std::string item;
+    while (std::getline(stream, item, ':')) {
+        fractions.push_back(std::stod(item));
+    }
+    if (fractions.size() != 3 || std::any_of(fractions.begin(), fractions.end(), [](double Fraction) {return Fraction < 0;})) {
+        throw std::invalid_argument("Invalid update mix: \"" + rMix + "\" (expecting non-negative insert:remove:query fractions)");
+    }
+    return UpdateMix {fractions[0], fractions[1], fractions[2]};
+}
+
+/// @brief Point set that changes between steps, like particles or contact surfaces.
+/// @details Removed points are picked at random from the active points, and inserted points
+///          are copies of random active points displaced by up to a given distance. Entities
+///          are never freed, because dynamic indices refer to them by their index in the pool.
+class DynamicPointSet
+{
+public:
+    static constexpr std::size_t Inactive = std::numeric_limits<std::size_t>::max();
+
+    DynamicPointSet(const EntityPointVectorType& rPoints, const double Displacement)
+        : mPool(rPoints),
+          mActive(rPoints.size()),
+          mActivePositions(rPoints.size()),
+          mDisplacement(Displacement)
+    {
+        std::iota(mActive.begin(), mActive.end(), 0);
+        std::iota(mActivePositions.begin(), mActivePositions.end(), 0);
+    }
+
+    /// @return Pool indices of the removed points.
+    std::vector<std::size_t> Remove(std::size_t Count)
+    {
+        Count = std::min(Count, mActive.size());
+        std::vector<std::size_t> output(Count);
+        for (auto& r_removed : output) {
+            const std::size_t i_active = this->GetRandomIndex(mActive.size());
+            r_removed = mActive[i_active];
+            mActive[i_active] = mActive.back();
+            mActivePositions[mActive[i_active]] = i_active;
+            mActive.pop_back();
+            mActivePositions[r_removed] = Inactive;
+        }
+        return output;
+    }
+
+    /// @return Range of pool indices of the inserted points.
+    std::pair<std::size_t,std::size_t> Insert(const std::size_t Count)
+    {
+        const std::size_t begin = mPool.size();
+        for (std::size_t i_point = 0; i_point < Count && !mActive.empty(); ++i_point) {
+            const Entity& r_source = *mPool[mActive[this->GetRandomIndex(mActive.size())]];
+            auto new_entity = std::make_shared<Entity>();
+            new_entity->mId = mPool.size() + 1;
+            for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+                new_entity->mPosition[i_dim] = r_source.mPosition[i_dim] + mDisplacement * (2.0 * this->GetRandom() - 1.0);
+            }
+            mActivePositions.push_back(mActive.size());
+            mActive.push_back(mPool.size());
+            mPool.push_back(new_entity);
+        }
+        return std::make_pair(begin, mPool.size());
+    }
+
+    /// @return Pool indices of random active points.
+    std::vector<std::size_t> Sample(std::size_t Count)
+    {
+        std::vector<std::size_t> output(mActive.empty() ? 0 : Count);
+        for (auto& r_index : output) {
+            r_index = mActive[this->GetRandomIndex(mActive.size())];
+        }
+        return output;
+    }
+
+    /// @brief All points that were ever inserted, including the removed ones.
+    const EntityPointVectorType& GetPool() const noexcept
+    {
+        return mPool;
+    }
+
+    std::size_t NumberOfActivePoints() const noexcept
+    {
+        return mActive.size();
+    }
+
+    EntityPointVectorType GetActivePoints() const
+    {
+        EntityPointVectorType output(mActive.size());
+        std::transform(mActive.begin(), mActive.end(), output.begin(), [this](std::size_t Index) {
+            return mPool[Index];
+        });
+        return output;
+    }
+
+private:
+    double GetRandom()
+    {
+        return HashToUnit(mCounter++);
+    }
+
+    std::size_t GetRandomIndex(const std::size_t Size)
+    {
+        return std::min<std::size_t>(this->GetRandom() * Size, Size - 1);
+    }
+
+    EntityPointVectorType mPool;
+
+    std::vector<std::size_t> mActive;
+
+    /// Position of each pool item in mActive, or Inactive.
+    std::vector<std::size_t> mActivePositions;
+
+    double mDisplacement;
+
+    std::uint64_t mCounter = 0x5eedull << 56;
+}; // class DynamicPointSet
+
+/// @brief nanoflann's dynamic index, which supports insertions and (lazy) removals.
+class NanoFlannDynamicIndex
+{
+public:
+    using TLS = NanoFlannResultVectorType;
+
+    static constexpr bool IsBounded = false;
+
+    NanoFlannDynamicIndex(const DynamicPointSet& rPointSet, const BenchmarkCase& rCase)
+        : mrPool(rPointSet.GetPool()),
+          mAdapter(mrPool),
+          mIndex(3, mAdapter, GetNanoFlannParameters(rCase)),
+          mSquaredRadius(rCase.mRadius * rCase.mRadius)
+    {
+    }
+
+    void Update(const std::vector<std::size_t>& rRemoved, const std::pair<std::size_t,std::size_t> Inserted)
+    {
+        for (const std::size_t i_removed : rRemoved) {
+            mIndex.removePoint(i_removed);
+        }
+        if (Inserted.first < Inserted.second) {
+            mIndex.addPoints(Inserted.first, Inserted.second - 1);
+        }
+    }
+
+    TLS MakeTLS() const
+    {
+        return TLS();
+    }
+
+    std::size_t Query(const Entity& rPoint, TLS& rTLS) const
+    {
+        nanoflann::RadiusResultSet<double, unsigned int> results(mSquaredRadius, rTLS);
+        mIndex.findNeighbors(results, rPoint.mPosition.data().begin());
+        return rTLS.size();
+    }
+
+    std::vector<const Entity*> Search(const Entity& rPoint) const
+    {
+        TLS tls;
+        this->Query(rPoint, tls);
+        std::vector<const Entity*> output(tls.size());
+        std::transform(tls.begin(), tls.end(), output.begin(), [this](const auto& rResult) {
+            return mrPool[rResult.first].get();
+        });
+        return output;
+    }
+
+private:
+    using Index = nanoflann::KDTreeSingleIndexDynamicAdaptor<NanoFlannDistanceMetricType, NanoFlannEntityAdapter, 3, unsigned int>;
+
+    const EntityPointVectorType& mrPool;
+
+    NanoFlannEntityAdapter mAdapter;
+
+    Index mIndex;
+
+    double mSquaredRadius;
+}; // class NanoFlannDynamicIndex
+
+/// @brief nanoflann's static index, rebuilt from the active points after each step.
+class NanoFlannRebuiltIndex
+{
+public:
+    using TLS = NanoFlannResultVectorType;
+
+    static constexpr bool IsBounded = false;
+
+    NanoFlannRebuiltIndex(const DynamicPointSet& rPointSet, const BenchmarkCase& rCase)
+        : mrPointSet(rPointSet),
+          mPoints(rPointSet.GetActivePoints()),
+          mAdapter(mPoints),
+          mIndex(3, mAdapter, GetNanoFlannParameters(rCase)),
+          mSquaredRadius(rCase.mRadius * rCase.mRadius)
+    {
+        mIndex.buildIndex();
+    }
+
+    void Update(const std::vector<std::size_t>&, std::pair<std::size_t,std::size_t>)
+    {
+        mPoints = mrPointSet.GetActivePoints();
+        mIndex.buildIndex();
+    }
+
+    TLS MakeTLS() const
+    {
+        return TLS();
+    }
+
+    std::size_t Query(const Entity& rPoint, TLS& rTLS) const
+    {
+        mIndex.radiusSearch(rPoint.mPosition.data().begin(), mSquaredRadius, rTLS, nanoflann::SearchParameters());
+        return rTLS.size();
+    }
+
+    std::vector<const Entity*> Search(const Entity& rPoint) const
+    {
+        TLS tls;
+        this->Query(rPoint, tls);
+        std::vector<const Entity*> output(tls.size());
+        std::transform(tls.begin(), tls.end(), output.begin(), [this](const auto& rResult) {
+            return mPoints[rResult.first].get();
+        });
+        return output;
+    }
+
+private:
+    const DynamicPointSet& mrPointSet;
+
+    EntityPointVectorType mPoints;
+
+    NanoFlannEntityAdapter mAdapter;
+
+    NanoFlannKDTreeIndexType mIndex;
+
+    double mSquaredRadius;
+}; // class NanoFlannRebuiltIndex
+
+/// @brief Kratos KD tree, rebuilt from the active points after each step.
+class KratosKDTreeRebuiltIndex
+{
+public:
+    using TLS = KratosKDtreeResults;
+
+    static constexpr bool IsBounded = true;
+
+    KratosKDTreeRebuiltIndex(const DynamicPointSet& rPointSet, const BenchmarkCase& rCase)
+        : mrPointSet(rPointSet),
+          mLeafSize(rCase.mLeafSize),
+          mRadius(rCase.mRadius)
+    {
+        this->Update({}, {});
+    }
+
+    void Update(const std::vector<std::size_t>&, std::pair<std::size_t,std::size_t>)
+    {
+        mPoints = mrPointSet.GetActivePoints();
+        mpTree = std::make_unique<KratosKDTreeType>(mPoints.begin(), mPoints.end(), mLeafSize);
+    }
+
+    TLS MakeTLS() const
+    {
+        return TLS(MaxNumberOfResults);
+    }
+
+    std::size_t Query(const Entity& rPoint, TLS& rTLS) const
+    {
+        return mpTree->SearchInRadius(rPoint, mRadius, rTLS.mNeighbours.begin(), rTLS.mDistances.begin(), MaxNumberOfResults);
+    }
+
+    std::vector<const Entity*> Search(const Entity& rPoint) const
+    {
+        TLS tls = this->MakeTLS();
+        const std::size_t number_of_results = this->Query(rPoint, tls);
+        std::vector<const Entity*> output(number_of_results);
+        std::transform(tls.mNeighbours.begin(), tls.mNeighbours.begin() + number_of_results, output.begin(), [](const auto& rpResult) {
+            return rpResult.get();
+        });
+        return output;
+    }
+
+private:
+    const DynamicPointSet& mrPointSet;
+
+    std::size_t mLeafSize;
+
+    double mRadius;
+
+    EntityPointVectorType mPoints;
+
+    std::unique_ptr<KratosKDTreeType> mpTree;
+}; // class KratosKDTreeRebuiltIndex
+
+/// @brief Interleave removals, insertions and radius searches on a dynamic point set.
+/// @details Each iteration is a step that removes points, inserts points displaced by up to
+///          the search radius, updates the index (@p TIndex), then queries random active points.
+///          Picking and creating points takes the same time for every index, and is included,
+///          as are the updates in the reported time per query.
+template <class TIndex>
+void DynamicUpdate(benchmark::State& rState, const BenchmarkCase& rCase)
+{
+    const auto p_points = GetPoints(rCase);
+    const UpdateMix mix = ParseUpdateMix(rCase.mUpdateMix);
+    const auto get_count = [&p_points](double Fraction) -> std::size_t {
+        return std::llround(Fraction * p_points->size());
+    };
+    const std::size_t number_of_insertions = get_count(mix.mInsert);
+    const std::size_t number_of_removals = get_count(mix.mRemove);
+    const std::size_t number_of_queries = get_count(mix.mQuery);
+
+    DynamicPointSet point_set(*p_points, rCase.mRadius);
+    TIndex index(point_set, rCase);
+
+    // Verify after a step, so that removed and inserted points are covered.
+    const auto step = [&]() {
+        const auto removed = point_set.Remove(number_of_removals);
+        const auto inserted = point_set.Insert(number_of_insertions);
+        index.Update(removed, inserted);
+    };
+    step();
+    const EntityPointVectorType active_points = point_set.GetActivePoints();
+    if (!CheckVerification(rState, VerifyRadiusSearch(active_points, rCase.mRadius, GetVerificationTolerance<double>(), [&index, &active_points](std::size_t Index) {
+        return index.Search(*active_points[Index]);
+    }))) return;
+
+    std::size_t max_results = 0;
+    for (auto _ : rState) {
+        step();
+        const auto queries = point_set.Sample(number_of_queries);
+        const auto& r_pool = point_set.GetPool();
+        max_results = Kratos::IndexPartition<std::size_t>(queries.size()).for_each<Kratos::MaxReduction<std::size_t>>(index.MakeTLS(), [&index, &queries, &r_pool](std::size_t Index, auto& rTLS) {
+            return index.Query(*r_pool[queries[Index]], rTLS);
+        });
+    }
+
+    SetCounters(rState, point_set.NumberOfActivePoints(), number_of_queries);
+    rState.counters["inserted"] = number_of_insertions;
+    rState.counters["removed"] = number_of_removals;
+    if (TIndex::IsBounded) {
+        CheckTruncation(rState, max_results);
+    }
+}
+
+// ======================================================================
+// ============================ Registration ============================
+// ======================================================================
+
+/// @brief Values of each benchmark parameter to sweep over.
+/// @details Benchmarks are registered for the cartesian product of all values
+///          that the benchmark depends on.
+struct SweepOptions
+{
+    std::vector<std::string> mDistributions {"lattice"};
+
+    std::vector<std::size_t> mPointCounts {1 << 12, 1 << 15, 1 << 18, 1 << 21};
+
+    std::vector<std::size_t> mLeafSizes {10};
+
+    std::vector<double> mRadii {0.05};
+
+    std::vector<std::size_t> mNeighbourCounts {1, 8, 32};
+
+    std::vector<std::string> mLayouts {"shared_ptr", "aos", "soa", "aos_float"};
+
+    std::vector<std::string> mStructures {"nanoflann", "kd_tree", "octree", "bins_dynamic", "bins_static"};
+
+    std::vector<std::string> mUpdateMixes {"0.001:0.001:0.1", "0.01:0.01:0.1", "0.1:0.1:0.1"};
+
+    std::vector<std::size_t> mChunkSizes {0};
+
+    std::vector<std::string> mPlacements {"serial", "first_touch_points"};
+
+    std::vector<std::string> mQueryOrders {"input", "morton"};
+
+    std::vector<std::string> mKernels {"scalar", "avx2", "avx512"};
+
+    std::vector<std::size_t> mThreadCounts {0};
+
+    /// Report hardware performance counters of search benchmarks (not swept).
+    bool mPerformanceCounters = false;
+};
+
+/// @brief Parameters that only some benchmarks depend on.
+/// @details A benchmark is only swept over the values of parameters it depends on.
+enum class SweepParameter : unsigned
+{
+    None = 0,
+    Radius = 1,
+    NumberOfNeighbours = 2,
+    Layout = 4,
+    Structure = 8,
+    UpdateMix = 16,
+    ChunkSize = 32,
+    Placement = 64,
+    QueryOrder = 128,
+    LeafKernel = 256
+};
+
+constexpr SweepParameter operator|(SweepParameter Left, SweepParameter Right) noexcept
+{
+    return static_cast<SweepParameter>(static_cast<unsigned>(Left) | static_cast<unsigned>(Right));
+}
+
+/// @brief Check whether a combination of @ref SweepParameter flags includes a parameter.
+constexpr bool HasParameter(SweepParameter Parameters, SweepParameter Parameter) noexcept
+{
+    return static_cast<unsigned>(Parameters) & static_cast<unsigned>(Parameter);
+}
+
+struct BenchmarkFamily
+{
+    std::string mName;
+
+    std::function<void(benchmark::State&,const BenchmarkCase&)> mFunction;
+
+    /// Combination of @ref SweepParameter flags.
+    SweepParameter mParameters;
+
+    /// Optional filter for cases the benchmark cannot run.
+    std::function<bool(const BenchmarkCase&)> mIsSupported = nullptr;
+};
+
+template <class T>
+T ParseValue(const std::string& rValue);
+
+template <>
+std::size_t ParseValue<std::size_t>(const std::string& rValue) { return std::stoull(rValue); }
+
+template <>
+double ParseValue<double>(const std::string& rValue) { return std::stod(rValue); }
+
+template <>
+std::string ParseValue<std::string>(const std::string& rValue) { return rValue; }
+
+/// @brief Parse a comma separated list of values.
+template <class T>
+std::vector<T> ParseList(const std::string& rList)
+{
+    std::vector<T> output;
+    std::stringstream stream(rList);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) output.push_back(ParseValue<T>(item));
+    }
+    if (output.empty()) throw std::invalid_argument("Empty list: \"" + rList + "\"");
+    return output;
+}
+
+/// @brief Read a list of values from a JSON array, if the key exists.
+template <class T>
+void ReadList(Kratos::Parameters Settings, const std::string& rKey, std::vector<T>& rOutput)
+{
+    if (!Settings.Has(rKey)) return;
+    Kratos::Parameters array = Settings[rKey];
+    if (!array.IsArray()) throw std::invalid_argument("\"" + rKey + "\" must be an array");
+    rOutput.clear();
+    for (std::size_t i_item = 0; i_item < array.size(); ++i_item) {
+        if constexpr (std::is_same_v<T,std::string>) {
+            rOutput.push_back(array[i_item].GetString());
+        } else if constexpr (std::is_same_v<T,double>) {
+            rOutput.push_back(array[i_item].GetDouble());
+        } else {
+            rOutput.push_back(static_cast<T>(array[i_item].GetInt()));
+        }
+    }
+}
+
+/// @brief Thread counts of a strong scaling study: powers of 2 up to the number of processors, and the number of processors.
+std::vector<std::size_t> GetScalingThreadCounts()
+{
+    const std::size_t number_of_processors = std::max(1, Kratos::ParallelUtilities::GetNumProcs());
+    std::vector<std::size_t> output;
+    for (std::size_t number_of_threads = 1; number_of_threads < number_of_processors; number_of_threads *= 2) {
+        output.push_back(number_of_threads);
+    }
+    output.push_back(number_of_processors);
+    return output;
+}
+
+void ReadConfiguration(const std::string& rFilePath, SweepOptions& rOptions)
+{
+    std::ifstream file(rFilePath);
+    if (!file) throw std::invalid_argument("Failed to open " + rFilePath);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    Kratos::Parameters settings(buffer.str());
+    ReadList(settings, "distributions", rOptions.mDistributions);
+    ReadList(settings, "point_counts", rOptions.mPointCounts);
+    ReadList(settings, "leaf_sizes", rOptions.mLeafSizes);
+    ReadList(settings, "radii", rOptions.mRadii);
+    ReadList(settings, "neighbour_counts", rOptions.mNeighbourCounts);
+    ReadList(settings, "layouts", rOptions.mLayouts);
+    ReadList(settings, "structures", rOptions.mStructures);
+    ReadList(settings, "update_mixes", rOptions.mUpdateMixes);
+    ReadList(settings, "chunk_sizes", rOptions.mChunkSizes);
+    ReadList(settings, "placements", rOptions.mPlacements);
+    ReadList(settings, "query_orders", rOptions.mQueryOrders);
+    ReadList(settings, "kernels", rOptions.mKernels);
+    if (settings.Has("thread_counts") && settings["thread_counts"].IsString() && settings["thread_counts"].GetString() == "scaling") {
+        rOptions.mThreadCounts = GetScalingThreadCounts();
+    } else {
+        ReadList(settings, "thread_counts", rOptions.mThreadCounts);
+    }
+}
+
+void PrintUsage()
+{
+    std::cout << "Usage: kratos_kd_tree_benchmark [options] [google benchmark options]\n"
+              << "Options (lists are comma separated):\n"
+              << "    --config=<file>        : read the lists below from a JSON file with the keys\n"
+              << "                             \"distributions\", \"point_counts\", \"leaf_sizes\", \"radii\",\n"
+              << "                             \"neighbour_counts\", \"layouts\", \"structures\",\n"
+              << "                             \"update_mixes\", \"chunk_sizes\", \"placements\",\n"
+              << "                             \"query_orders\", \"kernels\" and \"thread_counts\".\n"
+              << "                             Command line options take precedence.\n"
+              << "    --distributions=<list> : point distributions (lattice, random, clustered, graded,\n"
+              << "                             surface) or mesh files (e.g.: mesh.mdpa), whose nodes are\n"
+              << "                             scaled to the unit cube. Default: lattice.\n"
+              << "    --points=<list>        : number of points. Default: 4096,32768,262144,2097152.\n"
+              << "    --leaf-sizes=<list>    : maximum number of points in a leaf. Default: 10.\n"
+              << "    --radii=<list>         : search radii. Default: 0.05.\n"
+              << "    --neighbours=<list>    : number of neighbours in k-NN searches. Default: 1,8,32.\n"
+              << "    --layouts=<list>       : point storage layouts (shared_ptr, aos, soa, aos_float).\n"
+              << "                             Default: all of them.\n"
+              << "    --structures=<list>    : spatial search structures (nanoflann, kd_tree, octree,\n"
+              << "                             bins_dynamic, bins_static). Default: all of them.\n"
+              << "    --update-mixes=<list>  : insertions, removals and queries per step of dynamic point sets,\n"
+              << "                             relative to the number of points, as insert:remove:query.\n"
+              << "                             Default: 0.001:0.001:0.1,0.01:0.01:0.1,0.1:0.1:0.1.\n"
+              << "    --chunk-sizes=<list>   : queries per parallel chunk in thread scaling and batched\n"
+              << "                             benchmarks, 0 for one chunk per thread. Default: 0.\n"
+              << "    --placements=<list>    : allocation of the queried points in thread scaling benchmarks\n"
+              << "                             (serial, first_touch_points). Only the points are placed,\n"
+              << "                             indices are always constructed on the main thread.\n"
+              << "                             Default: serial,first_touch_points.\n"
+              << "    --query-orders=<list>  : order of queries in batched benchmarks (input, morton).\n"
+              << "                             Default: input,morton.\n"
+              << "    --kernels=<list>       : leaf distance kernels of the bucket KD tree (scalar, avx2,\n"
+              << "                             avx512). Kernels the CPU does not support are skipped.\n"
+              << "                             Default: all of them.\n"
+              << "    --threads=<list>       : number of threads, 0 for the environment's default, or \"scaling\"\n"
+              << "                             for powers of 2 up to the number of processors. Default: 0.\n"
+              << "    --perf-counters        : report cycles, instructions, branch misses, L1 data and last\n"
+              << "                             level cache misses per query in search benchmarks, through\n"
+              << "                             perf_event_open. Unavailable counters are skipped.\n"
+              << "Point counts do not apply to mesh files. Points are in the unit cube. Use --benchmark_filter=<regex> to select benchmarks.\n"
+              << "Search results are compared to a brute-force search on " << NumberOfVerifiedQueries << " sampled queries before timing;\n"
+              << "benchmarks with wrong or truncated results are reported as errors.\n"
+              << "Build benchmarks report the heap footprint of the index (index_bytes, index_bytes/point)\n"
+              << "and the peak heap usage during construction (peak_build_bytes).\n";
+}
+
+/// @brief Consume the options of this executable and leave the rest for google benchmark.
+SweepOptions ParseArguments(int& rArgc, char** pArgv)
+{
+    SweepOptions options;
+    std::string configuration;
+    std::vector<std::function<void()>> overrides;
+
+    int i_output = 1;
+    for (int i_arg = 1; i_arg < rArgc; ++i_arg) {
+        const std::string argument = pArgv[i_arg];
+        const auto split = argument.find('=');
+        const std::string key = argument.substr(0, split);
+        const std::string value = split == std::string::npos ? "" : argument.substr(split + 1);
+
+        if (key == "-h" || key == "--help") {
+            PrintUsage();
+            std::exit(0);
+        } else if (key == "--config") {
+            configuration = value;
+        } else if (key == "--distributions") {
+            overrides.emplace_back([&options, value]() { options.mDistributions = ParseList<std::string>(value); });
+        } else if (key == "--points") {
+            overrides.emplace_back([&options, value]() { options.mPointCounts = ParseList<std::size_t>(value); });
+        } else if (key == "--leaf-sizes") {
+            overrides.emplace_back([&options, value]() { options.mLeafSizes = ParseList<std::size_t>(value); });
+        } else if (key == "--radii") {
+            overrides.emplace_back([&options, value]() { options.mRadii = ParseList<double>(value); });
+        } else if (key == "--neighbours") {
+            overrides.emplace_back([&options, value]() { options.mNeighbourCounts = ParseList<std::size_t>(value); });
+        } else if (key == "--layouts") {
+            overrides.emplace_back([&options, value]() { options.mLayouts = ParseList<std::string>(value); });
+        } else if (key == "--structures") {
+            overrides.emplace_back([&options, value]() { options.mStructures = ParseList<std::string>(value); });
+        } else if (key == "--update-mixes") {
+            overrides.emplace_back([&options, value]() { options.mUpdateMixes = ParseList<std::string>(value); });
+        } else if (key == "--chunk-sizes") {
+            overrides.emplace_back([&options, value]() { options.mChunkSizes = ParseList<std::size_t>(value); });
+        } else if (key == "--placements") {
+            overrides.emplace_back([&options, value]() { options.mPlacements = ParseList<std::string>(value); });
+        } else if (key == "--query-orders") {
+            overrides.emplace_back([&options, value]() { options.mQueryOrders = ParseList<std::string>(value); });
+        } else if (key == "--kernels") {
+            overrides.emplace_back([&options, value]() { options.mKernels = ParseList<std::string>(value); });
+        } else if (key == "--perf-counters") {
+            options.mPerformanceCounters = true;
+        } else if (key == "--threads") {
+            overrides.emplace_back([&options, value]() {
+                options.mThreadCounts = value == "scaling" ? GetScalingThreadCounts() : ParseList<std::size_t>(value);
+            });
+        } else {
+            pArgv[i_output++] = pArgv[i_arg];
+        }
+    }
+    rArgc = i_output;
+
+    if (!configuration.empty()) {
+        ReadConfiguration(configuration, options);
+    }
+    for (const auto& r_override : overrides) {
+        r_override();
+    }
+
+    for (const auto& r_mix : options.mUpdateMixes) {
+        ParseUpdateMix(r_mix);
+    }
+    for (const auto& r_kernel : options.mKernels) {
+        ParseKernel(r_kernel);
+    }
+
+    return options;
+}
+
+std::string FormatCaseName(
+    const std::string& rFamilyName,
+    const BenchmarkCase& rCase,
+    const SweepParameter Parameters)
+{
+    std::stringstream name;
+    name << rFamilyName
+         << "/distribution:" << rCase.mDistribution;
+    if (rCase.mNumberOfPoints) {
+        name << "/points:" << rCase.mNumberOfPoints;
+    }
+    name << "/leaf_size:" << rCase.mLeafSize;
+    if (HasParameter(Parameters, SweepParameter::Radius)) {
+        name << "/radius:" << rCase.mRadius;
+    }
+    if (HasParameter(Parameters, SweepParameter::NumberOfNeighbours)) {
+        name << "/k:" << rCase.mNumberOfNeighbours;
+    }
+    if (HasParameter(Parameters, SweepParameter::Layout)) {
+        name << "/layout:" << rCase.mLayout;
+    }
+    if (HasParameter(Parameters, SweepParameter::Structure)) {
+        name << "/structure:" << rCase.mStructure;
+    }
+    if (HasParameter(Parameters, SweepParameter::UpdateMix)) {
+        name << "/mix:" << rCase.mUpdateMix;
+    }
+    if (HasParameter(Parameters, SweepParameter::ChunkSize)) {
+        name << "/chunk_size:" << rCase.mChunkSize;
+    }
+    if (HasParameter(Parameters, SweepParameter::Placement)) {
+        name << "/placement:" << rCase.mPlacement;
+    }
+    if (HasParameter(Parameters, SweepParameter::QueryOrder)) {
+        name << "/order:" << rCase.mQueryOrder;
+    }
+    if (HasParameter(Parameters, SweepParameter::LeafKernel)) {
+        name << "/kernel:" << rCase.mKernel;
+    }
+    if (rCase.mNumberOfThreads) {
+        name << "/threads:" << rCase.mNumberOfThreads;
+    }
+    return name.str();
+}
+
+/// @brief Replace each case with one copy per value of a parameter.
+template <class TValue, class TSetter>
+void Expand(
+    std::vector<BenchmarkCase>& rCases,
+    const std::vector<TValue>& rValues,
+    TSetter&& rSetter)
+{
+    std::vector<BenchmarkCase> output;
+    output.reserve(rCases.size() * rValues.size());
+    for (const auto& r_case : rCases) {
+        for (const auto& r_value : rValues) {
+            output.push_back(r_case);
+            rSetter(output.back(), r_value);
+        }
+    }
+    rCases.swap(output);
+}
+
+/// @brief Get the cartesian product of all parameter values a benchmark depends on.
+/// @details Parameters the benchmark does not depend on take their first value.
+std::vector<BenchmarkCase> GetCases(
+    const SweepOptions& rOptions,
+    const SweepParameter Parameters)
+{
+    const auto select = [Parameters](SweepParameter Parameter, const auto& rValues) {
+        return HasParameter(Parameters, Parameter) ? rValues : std::decay_t<decltype(rValues)> {rValues.front()};
+    };
+
+    std::vector<BenchmarkCase> cases(1);
+    Expand(cases, rOptions.mDistributions, [](BenchmarkCase& rCase, const std::string& rValue) { rCase.mDistribution = rValue; });
+    Expand(cases, rOptions.mPointCounts, [](BenchmarkCase& rCase, std::size_t Value) { rCase.mNumberOfPoints = Value; });
+
+    // Mesh files have a fixed number of points: keep one case per file.
+    cases.erase(std::remove_if(cases.begin(), cases.end(), [&rOptions](const BenchmarkCase& rCase) {
+        return IsPointFile(rCase.mDistribution) && rCase.mNumberOfPoints != rOptions.mPointCounts.front();
+    }), cases.end());
+    for (auto& r_case : cases) {
+        if (IsPointFile(r_case.mDistribution)) r_case.mNumberOfPoints = 0;
+    }
+
+    Expand(cases, rOptions.mLeafSizes, [](BenchmarkCase& rCase, std::size_t Value) { rCase.mLeafSize = Value; });
+    Expand(cases, select(SweepParameter::Radius, rOptions.mRadii), [](BenchmarkCase& rCase, double Value) { rCase.mRadius = Value; });
+    Expand(cases, select(SweepParameter::NumberOfNeighbours, rOptions.mNeighbourCounts), [](BenchmarkCase& rCase, std::size_t Value) { rCase.mNumberOfNeighbours = Value; });
+    Expand(cases, select(SweepParameter::Layout, rOptions.mLayouts), [](BenchmarkCase& rCase, const std::string& rValue) { rCase.mLayout = rValue; });
+    Expand(cases, select(SweepParameter::Structure, rOptions.mStructures), [](BenchmarkCase& rCase, const std::string& rValue) { rCase.mStructure = rValue; });
+    Expand(cases, select(SweepParameter::UpdateMix, rOptions.mUpdateMixes), [](BenchmarkCase& rCase, const std::string& rValue) { rCase.mUpdateMix = rValue; });
+    Expand(cases, select(SweepParameter::ChunkSize, rOptions.mChunkSizes), [](BenchmarkCase& rCase, std::size_t Value) { rCase.mChunkSize = Value; });
+    Expand(cases, select(SweepParameter::Placement, rOptions.mPlacements), [](BenchmarkCase& rCase, const std::string& rValue) { rCase.mPlacement = rValue; });
+    Expand(cases, select(SweepParameter::QueryOrder, rOptions.mQueryOrders), [](BenchmarkCase& rCase, const std::string& rValue) { rCase.mQueryOrder = rValue; });
+    Expand(cases, select(SweepParameter::LeafKernel, rOptions.mKernels), [](BenchmarkCase& rCase, const std::string& rValue) { rCase.mKernel = rValue; });
+    Expand(cases, rOptions.mThreadCounts, [](BenchmarkCase& rCase, std::size_t Value) { rCase.mNumberOfThreads = Value; });
+    return cases;
+}
+
+void RegisterBenchmarks(
+    const std::vector<BenchmarkFamily>& rFamilies,
+    const SweepOptions& rOptions)
+{
+    for (const auto& r_family : rFamilies) {
+        for (const auto& r_case : GetCases(rOptions, r_family.mParameters)) {
+            if (r_family.mIsSupported && !r_family.mIsSupported(r_case)) continue;
+            const auto function = r_family.mFunction;
+            benchmark::RegisterBenchmark(
+                FormatCaseName(r_family.mName, r_case, r_family.mParameters).c_str(),
+                [function, r_case](benchmark::State& rState) {
+                    const int default_number_of_threads = Kratos::ParallelUtilities::GetNumThreads();
+                    if (r_case.mNumberOfThreads) {
+                        Kratos::ParallelUtilities::SetNumThreads(r_case.mNumberOfThreads);
+                    }
+                    function(rState, r_case);
+                    Kratos::ParallelUtilities::SetNumThreads(default_number_of_threads);
+                })
+                ->Unit(benchmark::kMillisecond)
+                ->UseRealTime();
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    SweepOptions options;
+    try {
+        options = ParseArguments(argc, argv);
+    } catch (std::exception& rException) {
+        std::cerr << rException.what() << "\n";
+        PrintUsage();
+        return 1;
+    }
+
+    for (const auto& r_distribution : options.mDistributions) {
+        if (IsPointFile(r_distribution) && !std::filesystem::is_regular_file(r_distribution)) {
+            std::cerr << "File not found: " << r_distribution << "\n";
+            return 1;
+        }
+    }
+
+    if (options.mPerformanceCounters) {
+        pPerformanceCounters = std::make_unique<Kratos::Executables::PerformanceCounters>();
+        for (const auto& [r_event, r_reason] : pPerformanceCounters->GetUnavailableEvents()) {
+            std::cerr << "Performance counter " << r_event << " is unavailable: " << r_reason << "\n";
+        }
+        if (!pPerformanceCounters->IsAvailable()) {
+            pPerformanceCounters.reset();
+        }
+    }
+
+    // Mesh files are read through the kernel's IO.
+    std::vector<std::unique_ptr<Kratos::KratosApplication>> applications;
+    applications.emplace_back(new Kratos::KratosApplication("KratosCore"));
+    for (const auto& rp_application : applications) {
+        rp_application->Register();
+    }
+
+    const auto is_kernel_supported = [](const BenchmarkCase& rCase) {
+        return Kratos::Executables::BucketKDTree::IsSupported(ParseKernel(rCase.mKernel));
+    };
+
+    const std::vector<BenchmarkFamily> families {
+        {"NanoFlannKDTreeBuild", NanoFlannKDTreeBuild, SweepParameter::None},
+        {"NanoFlannKDTreeLoad", NanoFlannKDTreeLoad, SweepParameter::None},
+        {"NanoFlannKDTreeSearch", NanoFlannKDTreeSearch, SweepParameter::Radius},
+        {"NanoFlannKDTreeKNNSearch", NanoFlannKDTreeKNNSearch, SweepParameter::NumberOfNeighbours},
+        {"KratosKDTreeBuild", KratosContainerBuild<KratosKDTreeType>, SweepParameter::None},
+        {"KratosKDTreeSearch", KratosContainerSearch<KratosKDTreeType>, SweepParameter::Radius},
+        {"KratosKDTreeNearestPoint", KratosKDTreeNearestPoint, SweepParameter::None},
+        {"KratosKDTreeKNNSearch", KratosKDTreeKNNSearch, SweepParameter::NumberOfNeighbours},
+        {"NanoFlannLayoutSearch", NanoFlannLayoutSearch, SweepParameter::Radius | SweepParameter::Layout},
+        {"KratosKDTreeLayoutSearch", KratosKDTreeLayoutSearch, SweepParameter::Radius | SweepParameter::Layout, [](const BenchmarkCase& rCase) {
+            return rCase.mLayout == "shared_ptr" || rCase.mLayout == "aos";
+        }},
+        {"SpatialSearchBuild", SpatialSearchBuild, SweepParameter::Structure},
+        {"SpatialSearchRadius", SpatialSearchRadius, SweepParameter::Radius | SweepParameter::Structure},
+        {"ThreadScalingSearch", ThreadScalingSearch, SweepParameter::Radius | SweepParameter::Structure | SweepParameter::ChunkSize | SweepParameter::Placement},
+        {"BatchedRadiusSearch", BatchedRadiusSearch, SweepParameter::Radius | SweepParameter::Structure | SweepParameter::ChunkSize | SweepParameter::QueryOrder, [](const BenchmarkCase& rCase) {
+            return rCase.mStructure == "nanoflann" || rCase.mStructure == "kd_tree";
+        }},
+        {"NanoFlannKDTreeBufferSearch", NanoFlannKDTreeBufferSearch, SweepParameter::Radius},
+        {"KratosKDTreeBufferSearch", KratosKDTreeBufferSearch, SweepParameter::Radius},
+        {"KratosPartitionedKDTreeBuild", KratosPartitionedKDTreeBuild, SweepParameter::None},
+        {"KratosPartitionedKDTreeSearch", KratosPartitionedKDTreeSearch, SweepParameter::Radius},
+        {"BucketKDTreeBuild", BucketKDTreeBuild, SweepParameter::None, is_kernel_supported},
+        {"BucketKDTreeSearch", BucketKDTreeSearch, SweepParameter::Radius | SweepParameter::LeafKernel, is_kernel_supported},
+        {"NanoFlannDynamicUpdate", DynamicUpdate<NanoFlannDynamicIndex>, SweepParameter::Radius | SweepParameter::UpdateMix},
+        {"NanoFlannRebuildUpdate", DynamicUpdate<NanoFlannRebuiltIndex>, SweepParameter::Radius | SweepParameter::UpdateMix},
+        {"KratosKDTreeRebuildUpdate", DynamicUpdate<KratosKDTreeRebuiltIndex>, SweepParameter::Radius | SweepParameter::UpdateMix}
+    };
+    RegisterBenchmarks(families, options);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
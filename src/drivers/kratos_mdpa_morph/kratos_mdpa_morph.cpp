@@ -0,0 +1,408 @@
+// --- Internal Includes ---
+#include "KratosExecutables/ModelPartIO.hpp" // Executables::IOFactory
+
+// --- Core Includes ---
+#include "includes/kratos_application.h" // KratosApplication
+#include "includes/variables.h" // DISPLACEMENT
+#include "utilities/parallel_utilities.h" // block_for_each, IndexPartition
+#include "utilities/reduction_utilities.h" // SumReduction
+
+// --- STL Includes ---
+#include <iostream> // std::cout, std::cerr
+#include <fstream> // std::ifstream
+#include <sstream> // std::istringstream
+#include <vector> // std::vector
+#include <array> // std::array
+#include <filesystem> // std::filesystem::path, std::filesystem::exists, std::filesystem::is_directory
+#include <memory> // std::unique_ptr
+#include <string> // std::string
+#include <algorithm> // std::sort, std::lower_bound
+#include <cmath> // std::sqrt, std::floor
+#include <cstdint> // std::int64_t
+#include <stdexcept> // std::invalid_argument
+
+
+/// @brief Control point of an RBF interpolation: a position and its prescribed displacement.
+struct ControlPoint
+{
+    std::array<double,3> mPosition;
+    std::array<double,3> mDisplacement;
+}; // struct ControlPoint
+
+
+std::vector<ControlPoint> ReadControlPoints(const std::filesystem::path& rFilePath)
+{
+    std::ifstream file(rFilePath);
+    KRATOS_ERROR_IF_NOT(file) << "Failed to open " << rFilePath;
+
+    std::vector<ControlPoint> output;
+    std::string line;
+    std::size_t i_line = 0;
+    while (std::getline(file, line)) {
+        ++i_line;
+        const auto i_begin = line.find_first_not_of(" \t\r");
+        if (i_begin == std::string::npos || line[i_begin] == '#') continue;
+
+        std::istringstream stream(line);
+        ControlPoint point;
+        KRATOS_ERROR_IF_NOT(stream >> point.mPosition[0] >> point.mPosition[1] >> point.mPosition[2]
+                                   >> point.mDisplacement[0] >> point.mDisplacement[1] >> point.mDisplacement[2])
+            << "Expecting \"x y z dx dy dz\" on line " << i_line << " of " << rFilePath << ", but got \"" << line << "\"";
+        output.push_back(point);
+    }
+
+    return output;
+}
+
+
+/// @brief Uniform grid over a set of points, for finding all points within a fixed radius.
+/// @details The cell size equals the search radius, so a query only visits the 27 cells around it.
+///          Points are sorted by their cell indices, and cells are located by binary search.
+class PointGrid
+{
+public:
+    PointGrid(const std::vector<ControlPoint>& rPoints, double Radius)
+        : mRadius(Radius),
+          mEntries(rPoints.size())
+    {
+        KRATOS_ERROR_IF_NOT(0.0 < Radius) << "The search radius must be positive, but got " << Radius;
+        Kratos::IndexPartition<std::size_t>(rPoints.size()).for_each([this, &rPoints](std::size_t Index) {
+            mEntries[Index] = std::make_pair(this->GetCell(rPoints[Index].mPosition), Index);
+        });
+        std::sort(mEntries.begin(), mEntries.end());
+    }
+
+    /// @brief Call a functor with the index of every point within the radius, and its distance.
+    template <class TFunctor>
+    void ForEachNeighbor(const std::vector<ControlPoint>& rPoints,
+                         const std::array<double,3>& rPosition,
+                         TFunctor&& rFunctor) const
+    {
+        const auto cell = this->GetCell(rPosition);
+        for (std::int64_t i = cell[0] - 1; i <= cell[0] + 1; ++i) {
+            for (std::int64_t j = cell[1] - 1; j <= cell[1] + 1; ++j) {
+                for (std::int64_t k = cell[2] - 1; k <= cell[2] + 1; ++k) {
+                    const Cell key {i, j, k};
+                    auto it_entry = std::lower_bound(mEntries.begin(), mEntries.end(), std::make_pair(key, std::size_t(0)));
+                    for (; it_entry != mEntries.end() && it_entry->first == key; ++it_entry) {
+                        const auto& r_other = rPoints[it_entry->second].mPosition;
+                        const double dx = rPosition[0] - r_other[0];
+                        const double dy = rPosition[1] - r_other[1];
+                        const double dz = rPosition[2] - r_other[2];
+                        const double distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+                        if (distance < mRadius) {
+                            rFunctor(it_entry->second, distance);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    using Cell = std::array<std::int64_t,3>;
+
+    Cell GetCell(const std::array<double,3>& rPosition) const noexcept
+    {
+        return {static_cast<std::int64_t>(std::floor(rPosition[0] / mRadius)),
+                static_cast<std::int64_t>(std::floor(rPosition[1] / mRadius)),
+                static_cast<std::int64_t>(std::floor(rPosition[2] / mRadius))};
+    }
+
+    double mRadius;
+
+    std::vector<std::pair<Cell,std::size_t>> mEntries;
+}; // class PointGrid
+
+
+/// @brief Wendland's C2 function with compact support, positive definite in 3D.
+double Wendland(double Distance, double Radius) noexcept
+{
+    const double r = Distance / Radius;
+    if (1.0 <= r) return 0.0;
+    const double t = 1.0 - r;
+    return t * t * t * t * (4.0 * r + 1.0);
+}
+
+
+/// @brief Interpolation of control point displacements with compactly supported radial basis functions.
+/// @details The interpolation matrix is sparse and symmetric positive definite, so the weights are found by
+///          conjugate gradients on a matrix assembled from radius queries. Evaluating the interpolant at a
+///          point only involves control points within the support radius, so the total cost is
+///          proportional to the number of evaluated points rather than to the product of both counts.
+class RBFInterpolation
+{
+public:
+    RBFInterpolation(std::vector<ControlPoint>&& rControlPoints, double Radius)
+        : mControlPoints(std::move(rControlPoints)),
+          mRadius(Radius),
+          mGrid(mControlPoints, Radius),
+          mWeights(mControlPoints.size())
+    {
+        const std::size_t size = mControlPoints.size();
+
+        // Assemble the interpolation matrix in CSR format.
+        std::vector<std::vector<std::pair<std::size_t,double>>> rows(size);
+        Kratos::IndexPartition<std::size_t>(size).for_each([this, &rows](std::size_t Index) {
+            mGrid.ForEachNeighbor(mControlPoints, mControlPoints[Index].mPosition, [this, &rows, Index](std::size_t iNeighbor, double Distance) {
+                rows[Index].emplace_back(iNeighbor, Wendland(Distance, mRadius));
+            });
+        });
+
+        std::vector<std::size_t> row_extents(size + 1, 0);
+        for (std::size_t i_row = 0; i_row < size; ++i_row) {
+            row_extents[i_row + 1] = row_extents[i_row] + rows[i_row].size();
+        }
+        std::vector<std::size_t> columns(row_extents.back());
+        std::vector<double> values(row_extents.back());
+        Kratos::IndexPartition<std::size_t>(size).for_each([&](std::size_t Index) {
+            for (std::size_t i_entry = 0; i_entry < rows[Index].size(); ++i_entry) {
+                columns[row_extents[Index] + i_entry] = rows[Index][i_entry].first;
+                values[row_extents[Index] + i_entry] = rows[Index][i_entry].second;
+            }
+        });
+        rows.clear();
+
+        const auto product = [&](const std::vector<double>& rVector, std::vector<double>& rOutput) {
+            Kratos::IndexPartition<std::size_t>(size).for_each([&](std::size_t Index) {
+                double value = 0.0;
+                for (std::size_t i_entry = row_extents[Index]; i_entry < row_extents[Index + 1]; ++i_entry) {
+                    value += values[i_entry] * rVector[columns[i_entry]];
+                }
+                rOutput[Index] = value;
+            });
+        };
+
+        const auto dot = [size](const std::vector<double>& rLeft, const std::vector<double>& rRight) {
+            return Kratos::IndexPartition<std::size_t>(size).for_each<Kratos::SumReduction<double>>([&](std::size_t Index) {
+                return rLeft[Index] * rRight[Index];
+            });
+        };
+
+        // Solve for each displacement component with conjugate gradients.
+        std::vector<double> solution(size), residual(size), direction(size), image(size);
+        for (std::size_t i_component = 0; i_component < 3; ++i_component) {
+            std::fill(solution.begin(), solution.end(), 0.0);
+            for (std::size_t i = 0; i < size; ++i) {
+                residual[i] = mControlPoints[i].mDisplacement[i_component];
+            }
+            direction = residual;
+
+            const double tolerance = 1e-24 * std::max(dot(residual, residual), 1e-300);
+            double residual_norm = dot(residual, residual);
+            for (std::size_t i_iteration = 0; i_iteration < 10 * size && tolerance < residual_norm; ++i_iteration) {
+                product(direction, image);
+                const double step = residual_norm / dot(direction, image);
+                Kratos::IndexPartition<std::size_t>(size).for_each([&](std::size_t Index) {
+                    solution[Index] += step * direction[Index];
+                    residual[Index] -= step * image[Index];
+                });
+                const double new_residual_norm = dot(residual, residual);
+                const double beta = new_residual_norm / residual_norm;
+                residual_norm = new_residual_norm;
+                Kratos::IndexPartition<std::size_t>(size).for_each([&](std::size_t Index) {
+                    direction[Index] = residual[Index] + beta * direction[Index];
+                });
+            }
+
+            KRATOS_ERROR_IF(tolerance < residual_norm)
+                << "RBF weights did not converge for component " << i_component
+                << " (residual " << std::sqrt(residual_norm) << ")";
+
+            for (std::size_t i = 0; i < size; ++i) {
+                mWeights[i][i_component] = solution[i];
+            }
+        }
+    }
+
+    std::array<double,3> Evaluate(const std::array<double,3>& rPosition) const
+    {
+        std::array<double,3> output {0.0, 0.0, 0.0};
+        mGrid.ForEachNeighbor(mControlPoints, rPosition, [this, &output](std::size_t iNeighbor, double Distance) {
+            const double value = Wendland(Distance, mRadius);
+            for (std::size_t i_component = 0; i_component < 3; ++i_component) {
+                output[i_component] += value * mWeights[iNeighbor][i_component];
+            }
+        });
+        return output;
+    }
+
+private:
+    std::vector<ControlPoint> mControlPoints;
+
+    double mRadius;
+
+    PointGrid mGrid;
+
+    std::vector<std::array<double,3>> mWeights;
+}; // class RBFInterpolation
+
+
+void MoveNode(Kratos::Node& rNode, const std::array<double,3>& rDisplacement, double Scale)
+{
+    for (std::size_t i_component = 0; i_component < 3; ++i_component) {
+        const double value = rNode.GetInitialPosition()[i_component] + Scale * rDisplacement[i_component];
+        rNode.GetInitialPosition()[i_component] = value;
+        rNode.Coordinates()[i_component] = value;
+    }
+}
+
+
+/// @brief Move nodes by the DISPLACEMENT of the nodes with the same IDs in a field model part.
+/// @return Number of nodes that have no counterpart in the field and were left in place.
+std::size_t ApplyField(Kratos::ModelPart& rModelPart,
+                       const Kratos::ModelPart& rField,
+                       double Scale)
+{
+    const auto& r_field_nodes = rField.Nodes();
+    return Kratos::block_for_each<Kratos::SumReduction<std::size_t>>(rModelPart.Nodes(), [&r_field_nodes, Scale](Kratos::Node& rNode) -> std::size_t {
+        const auto it_field_node = r_field_nodes.find(rNode.Id());
+        if (it_field_node == r_field_nodes.end()) return 1;
+        const auto& r_displacement = it_field_node->FastGetSolutionStepValue(Kratos::DISPLACEMENT);
+        MoveNode(rNode, {r_displacement[0], r_displacement[1], r_displacement[2]}, Scale);
+        return 0;
+    });
+}
+
+
+void ApplyRBF(Kratos::ModelPart& rModelPart,
+              const RBFInterpolation& rInterpolation,
+              double Scale)
+{
+    Kratos::block_for_each(rModelPart.Nodes(), [&rInterpolation, Scale](Kratos::Node& rNode) {
+        const auto& r_position = rNode.GetInitialPosition();
+        MoveNode(rNode, rInterpolation.Evaluate({r_position[0], r_position[1], r_position[2]}), Scale);
+    });
+}
+
+
+void PrintUsage()
+{
+    std::cerr << "Usage: kratos_mdpa_morph [options] input_path output_path\n"
+              << "Deform a mesh by a nodal displacement field.\n"
+              << "Options:\n"
+              << "    --field <path>          : read nodal DISPLACEMENT from a file, matching nodes by ID.\n"
+              << "                              MDPA files provide it in NodalData blocks, HDF5 files in /ResultsData.\n"
+              << "    --control-points <path> : interpolate displacements from a text file with\n"
+              << "                              \"x y z dx dy dz\" on each line, using compactly supported RBFs.\n"
+              << "    --rbf-radius <r>        : support radius of the RBFs (required with --control-points).\n"
+              << "                              Nodes farther than this from every control point do not move.\n"
+              << "    --scale <s>             : multiply displacements by a factor (default: 1).\n";
+}
+
+
+int main(int argc, const char** argv)
+{
+    std::filesystem::path field_path;
+    std::filesystem::path control_points_path;
+    double rbf_radius = 0.0;
+    double scale = 1.0;
+    std::vector<std::filesystem::path> paths;
+
+    for (int i_arg=1; i_arg<argc; ++i_arg) {
+        const std::string argument = argv[i_arg];
+        if (argument == "--field" && i_arg + 1 < argc) {
+            field_path = argv[++i_arg];
+        } else if (argument == "--control-points" && i_arg + 1 < argc) {
+            control_points_path = argv[++i_arg];
+        } else if ((argument == "--rbf-radius" || argument == "--scale") && i_arg + 1 < argc) {
+            const std::string value = argv[++i_arg];
+            try {
+                std::size_t size = 0;
+                const double parsed = std::stod(value, &size);
+                if (size != value.size()) throw std::invalid_argument(value);
+                (argument == "--scale" ? scale : rbf_radius) = parsed;
+            } catch (const std::exception&) {
+                std::cerr << "Invalid value for " << argument << ": " << value << "\n";
+                PrintUsage();
+                return 1;
+            }
+        } else if (argument == "-h" || argument == "--help") {
+            PrintUsage();
+            return 0;
+        } else if (argument.rfind("--", 0) == 0) {
+            std::cerr << "Unknown option or missing value: " << argument << "\n";
+            PrintUsage();
+            return 1;
+        } else {
+            paths.emplace_back(argument);
+        }
+    } // for i_arg in range(1, argc)
+
+    if (paths.size() != 2) {
+        std::cerr << "kratos_mdpa_morph expects exactly 2 arguments: input file path and output file path\n";
+        PrintUsage();
+        return 1;
+    }
+    const std::filesystem::path source = paths[0], target = paths[1];
+
+    if (field_path.empty() == control_points_path.empty()) {
+        std::cerr << "Exactly one of --field and --control-points must be provided\n";
+        return 1;
+    }
+
+    if (!control_points_path.empty() && rbf_radius <= 0.0) {
+        std::cerr << "--control-points requires a positive --rbf-radius\n";
+        return 1;
+    }
+
+    for (const auto& r_path : {source, field_path, control_points_path}) {
+        if (!r_path.empty() && (!std::filesystem::exists(r_path) || std::filesystem::is_directory(r_path))) {
+            std::cerr << "File not found: " << r_path << "\n";
+            return 1;
+        }
+    }
+
+    if (std::filesystem::is_directory(target)) {
+        std::cerr << "Output path is a directory: " << target << "\n";
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<Kratos::KratosApplication>> applications;
+    applications.emplace_back(new Kratos::KratosApplication("KratosCore"));
+    for (const auto& rp_application : applications) {
+        rp_application->Register();
+    }
+
+    const auto p_source_io = Kratos::Executables::IOFactory(source);
+    const auto p_target_io = Kratos::Executables::IOFactory(target);
+
+    Kratos::Model model;
+    Kratos::ModelPart& r_model_part = model.CreateModelPart("source");
+
+    try {
+        p_source_io->Read(r_model_part);
+    } catch (std::exception& rException) {
+        std::cerr << "Error reading " << source << ":\n" << rException.what() << "\n";
+        return 1;
+    }
+
+    try {
+        if (!field_path.empty()) {
+            Kratos::ModelPart& r_field = model.CreateModelPart("field");
+            r_field.AddNodalSolutionStepVariable(Kratos::DISPLACEMENT);
+            Kratos::Executables::IOFactory(field_path)->Read(r_field);
+            const std::size_t missing = ApplyField(r_model_part, r_field, scale);
+            if (missing) {
+                std::cout << missing << " nodes have no displacement in " << field_path << " and were not moved\n";
+            }
+        } else {
+            auto control_points = ReadControlPoints(control_points_path);
+            std::cout << "Fitting RBF interpolation to " << control_points.size() << " control points\n";
+            const RBFInterpolation interpolation(std::move(control_points), rbf_radius);
+            ApplyRBF(r_model_part, interpolation, scale);
+        }
+    } catch (std::exception& rException) {
+        std::cerr << "Error computing displacements:\n" << rException.what() << "\n";
+        return 1;
+    }
+
+    try {
+        p_target_io->Write(r_model_part);
+    } catch (std::exception& rException) {
+        std::cerr << "Error writing " << target << ":\n" << rException.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,5 +1,19 @@
 // System includes
 #include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cctype>
+#include <array>
+#include <fstream>
+#include <charconv>
+#include <string_view>
+#include <filesystem>
+#include <algorithm>
+#include <system_error>
+#include <exception>
 
 // Kratos includes
 #include "includes/kernel.h"
@@ -7,34 +21,380 @@
 #include "structural_mechanics_application.h"
 #include "utilities/parallel_utilities.h"
 
+// Internal includes
+#include "KratosExecutables/AffineTransform.hpp"
+
 using namespace Kratos;
 
+using Executables::AffineTransform;
+
+/// @brief Parse an axis name (x, y or z) into a unit vector.
+std::array<double,3> ParseAxis(const std::string& rName)
+{
+    if (rName == "x") return {1.0, 0.0, 0.0};
+    if (rName == "y") return {0.0, 1.0, 0.0};
+    if (rName == "z") return {0.0, 0.0, 1.0};
+    std::cout << "Invalid axis '" << rName << "'. Options are x, y and z." << std::endl;
+    std::exit(-1);
+}
+
+/// @brief Get the length of a unit in meters.
+double GetUnitLength(const std::string& rName)
+{
+    const std::map<std::string,double> units {
+        {"km", 1e3},
+        {"m", 1.0},
+        {"dm", 1e-1},
+        {"cm", 1e-2},
+        {"mm", 1e-3},
+        {"um", 1e-6},
+        {"in", 0.0254},
+        {"ft", 0.3048}
+    };
+    const auto it_unit = units.find(rName);
+    if (it_unit == units.end()) {
+        std::cout << "Invalid unit '" << rName << "'. Options are:";
+        for (const auto& r_pair : units) std::cout << " " << r_pair.first;
+        std::cout << std::endl;
+        std::exit(-1);
+    }
+    return it_unit->second;
+}
+
+/// @brief Transform the nodes of a model part in a single pass.
+/// @details Coordinates are gathered into a contiguous array, transformed, then scattered back
+///          to both the current and the initial positions.
+void TransformNodes(ModelPart& rModelPart, const AffineTransform& rTransform)
+{
+    auto& r_nodes = rModelPart.Nodes();
+    const std::size_t number_of_nodes = r_nodes.size();
+
+    std::vector<double> coordinates(3 * number_of_nodes);
+    IndexPartition<std::size_t>(number_of_nodes).for_each([&r_nodes, &coordinates](const std::size_t Index) {
+        const auto& r_node = *(r_nodes.begin() + Index);
+        coordinates[3 * Index] = r_node.X();
+        coordinates[3 * Index + 1] = r_node.Y();
+        coordinates[3 * Index + 2] = r_node.Z();
+    });
+
+    rTransform.Apply(coordinates.data(), number_of_nodes);
+
+    IndexPartition<std::size_t>(number_of_nodes).for_each([&r_nodes, &coordinates](const std::size_t Index) {
+        auto& r_node = *(r_nodes.begin() + Index);
+        for (std::size_t i_component = 0; i_component < 3; ++i_component) {
+            r_node.Coordinates()[i_component] = coordinates[3 * Index + i_component];
+            r_node.GetInitialPosition().Coordinates()[i_component] = coordinates[3 * Index + i_component];
+        }
+    });
+}
+
+/// @brief Check whether a line opens or closes a nodes block, ignoring surrounding whitespace.
+bool IsBlockLine(std::string_view Line, std::string_view Keyword)
+{
+    const auto skip_whitespace = [&Line]() {
+        while (!Line.empty() && std::isspace(static_cast<unsigned char>(Line.front()))) Line.remove_prefix(1);
+    };
+    skip_whitespace();
+    if (Line.substr(0, Keyword.size()) != Keyword) return false;
+    Line.remove_prefix(Keyword.size());
+    if (Line.empty() || !std::isspace(static_cast<unsigned char>(Line.front()))) return false;
+    skip_whitespace();
+    if (Line.substr(0, 5) != "Nodes") return false;
+    Line.remove_prefix(5);
+    skip_whitespace();
+    return Line.empty() || Line.substr(0, 2) == "//";
+}
+
+/// @brief Check whether a line is blank or a comment.
+bool IsBlankOrComment(std::string_view Line)
+{
+    const auto it_begin = std::find_if(Line.begin(), Line.end(), [](char Character) {
+        return !std::isspace(static_cast<unsigned char>(Character));
+    });
+    Line.remove_prefix(std::distance(Line.begin(), it_begin));
+    return Line.empty() || Line.substr(0, 2) == "//";
+}
+
+/// @brief Parse a node line of the form "<id> <x> <y> <z>".
+/// @return False if the line is not a valid node definition, including trailing content after the coordinates.
+bool ParseNode(std::string_view Line, std::size_t& rId, double* pCoordinates)
+{
+    const char* p_current = Line.data();
+    const char* p_end = Line.data() + Line.size();
+    const auto skip_whitespace = [&p_current, p_end]() {
+        while (p_current != p_end && std::isspace(static_cast<unsigned char>(*p_current))) ++p_current;
+    };
+
+    skip_whitespace();
+    auto result = std::from_chars(p_current, p_end, rId);
+    if (result.ec != std::errc()) return false;
+    p_current = result.ptr;
+
+    for (std::size_t i_component = 0; i_component < 3; ++i_component) {
+        skip_whitespace();
+        if (p_current != p_end && *p_current == '+') ++p_current;
+        result = std::from_chars(p_current, p_end, pCoordinates[i_component]);
+        if (result.ec != std::errc()) return false;
+        p_current = result.ptr;
+    }
+
+    skip_whitespace();
+    return p_current == p_end;
+}
+
+/// @brief Apply a transformation to the nodes of an MDPA file without constructing a model part.
+/// @details Everything outside "Begin Nodes" blocks is copied through verbatim. Node lines are parsed,
+///          transformed and formatted in fixed size batches, so memory use does not depend on the mesh size.
+///          Comments and blank lines within nodes blocks are kept, but flush the current batch to preserve order.
+///          Any other line in a nodes block is an error, and removes the partially written output.
+void StreamTransform(
+    const std::filesystem::path& rInputPath,
+    const std::filesystem::path& rOutputPath,
+    const AffineTransform& rTransform)
+{
+    constexpr std::size_t batch_size = 1 << 16;
+    constexpr std::size_t buffer_size = 1 << 20;
+
+    // The buffers must outlive the streams that use them.
+    std::vector<char> input_buffer(buffer_size);
+    std::vector<char> output_buffer(buffer_size);
+
+    std::ifstream input;
+    input.rdbuf()->pubsetbuf(input_buffer.data(), input_buffer.size());
+    input.open(rInputPath, std::ios::binary);
+    if (!input) {
+        std::cout << "Failed to open " << rInputPath << " for reading." << std::endl;
+        std::exit(-1);
+    }
+
+    std::ofstream output;
+    output.rdbuf()->pubsetbuf(output_buffer.data(), output_buffer.size());
+    output.open(rOutputPath, std::ios::binary);
+    if (!output) {
+        std::cout << "Failed to open " << rOutputPath << " for writing." << std::endl;
+        std::exit(-1);
+    }
+
+    std::vector<std::size_t> ids;
+    std::vector<double> coordinates;
+    std::vector<char> formatted;
+    ids.reserve(batch_size);
+    coordinates.reserve(3 * batch_size);
+
+    // Each line is at most an ID, 3 coordinates, separators and a newline.
+    constexpr std::size_t max_line_size = 20 + 3 * 25 + 4;
+    formatted.resize(batch_size * max_line_size);
+
+    const auto flush = [&]() {
+        rTransform.Apply(coordinates.data(), ids.size());
+        char* p_current = formatted.data();
+        char* p_end = formatted.data() + formatted.size();
+        for (std::size_t i_node = 0; i_node < ids.size(); ++i_node) {
+            *p_current++ = '\t';
+            p_current = std::to_chars(p_current, p_end, ids[i_node]).ptr;
+            for (std::size_t i_component = 0; i_component < 3; ++i_component) {
+                *p_current++ = '\t';
+                p_current = std::to_chars(p_current, p_end, coordinates[3 * i_node + i_component], std::chars_format::scientific, 16).ptr;
+            }
+            *p_current++ = '\n';
+        }
+        output.write(formatted.data(), std::distance(formatted.data(), p_current));
+        ids.clear();
+        coordinates.clear();
+    };
+
+    std::size_t number_of_nodes = 0;
+    std::size_t line_number = 0;
+    bool in_nodes_block = false;
+    std::string line;
+    while (std::getline(input, line)) {
+        const bool has_newline = !input.eof();
+        ++line_number;
+        if (in_nodes_block) {
+            if (IsBlockLine(line, "End")) {
+                in_nodes_block = false;
+            } else if (!IsBlankOrComment(line)) {
+                std::size_t id;
+                double node_coordinates[3];
+                if (!ParseNode(line, id, node_coordinates)) {
+                    std::cout << "Invalid node definition at line " << line_number << " of " << rInputPath << ": " << line << std::endl;
+                    output.close();
+                    std::filesystem::remove(rOutputPath);
+                    std::exit(-1);
+                }
+                ids.push_back(id);
+                coordinates.insert(coordinates.end(), node_coordinates, node_coordinates + 3);
+                ++number_of_nodes;
+                if (ids.size() == batch_size) flush();
+                continue;
+            }
+            flush();
+        } else {
+            in_nodes_block = IsBlockLine(line, "Begin");
+        }
+        output.write(line.data(), line.size());
+        if (has_newline) output.put('\n');
+    }
+
+    if (in_nodes_block) {
+        std::cout << "Unterminated nodes block in " << rInputPath << "." << std::endl;
+        output.close();
+        std::filesystem::remove(rOutputPath);
+        std::exit(-1);
+    }
+
+    output.close();
+    if (!output) {
+        std::cout << "Failed to write " << rOutputPath << "." << std::endl;
+        std::exit(-1);
+    }
+
+    std::cout << "Transformed " << number_of_nodes << " nodes." << std::endl;
+}
+
+void PrintUsage()
+{
+    std::cout << "Usage: kratos_mdpa_scale_dimensions [options] <input> <output> [scaling factor]" << std::endl
+              << "Apply a chain of affine transformations to the nodes of an MDPA mesh." << std::endl
+              << "Input and output mesh names are without the .mdpa extension." << std::endl
+              << "Transformations are applied in the order they are provided, but composed" << std::endl
+              << "into a single matrix so the nodes are only processed once." << std::endl
+              << "Options:" << std::endl
+              << "    --scale <s>                 : uniform scaling." << std::endl
+              << "    --scale-axes <sx> <sy> <sz> : scaling along each axis." << std::endl
+              << "    --translate <x> <y> <z>     : translation." << std::endl
+              << "    --rotate <axis> <degrees>   : rotation around the x, y or z axis." << std::endl
+              << "    --mirror <axis>             : reflection across the plane normal to the x, y or z axis." << std::endl
+              << "    --units <from> <to>         : unit conversion (km, m, dm, cm, mm, um, in, ft)." << std::endl
+              << "    --matrix <m00> ... <m33>    : 16 components of a row-major 4x4 affine matrix." << std::endl
+              << "    --stream                    : rewrite only the nodes blocks of the input file and copy" << std::endl
+              << "                                  everything else verbatim, without constructing a model part." << std::endl
+              << "    -h, --help                  : print this message and exit." << std::endl
+              << "A trailing scaling factor is equivalent to --scale at the end of the chain." << std::endl;
+}
+
+/// @brief Parse a number, or print the usage and exit if it is not one in its entirety.
+double ParseValue(const std::string& rOption, const std::string& rValue)
+{
+    try {
+        std::size_t size = 0;
+        const double value = std::stod(rValue, &size);
+        if (size == rValue.size()) return value;
+    } catch (const std::exception&) {
+    }
+    std::cout << "Invalid value for " << rOption << ": '" << rValue << "'." << std::endl;
+    PrintUsage();
+    std::exit(-1);
+}
+
 int main(int argc, char *argv[])
 {
     Kernel kernel;
 
-    if (argc != 4) {
-        std::cout << "Please provide input mesh name, output mesh name without the .mdpa extension and scaling factor" << std::endl;
+    AffineTransform transform;
+    std::vector<std::string> positionals;
+    bool stream = false;
+
+    for (int i_arg = 1; i_arg < argc; ++i_arg) {
+        const std::string argument = argv[i_arg];
+        const auto require = [argc, i_arg, &argument](int NumberOfValues) {
+            if (argc <= i_arg + NumberOfValues) {
+                std::cout << argument << " expects " << NumberOfValues << " value(s)." << std::endl;
+                std::exit(-1);
+            }
+        };
+
+        if (argument == "-h" || argument == "--help") {
+            PrintUsage();
+            return 0;
+        } else if (argument == "--stream") {
+            stream = true;
+        } else if (argument == "--scale") {
+            require(1);
+            transform = AffineTransform::Scale(ParseValue(argument, argv[i_arg + 1])) * transform;
+            i_arg += 1;
+        } else if (argument == "--scale-axes") {
+            require(3);
+            transform = AffineTransform::Scale(ParseValue(argument, argv[i_arg + 1]), ParseValue(argument, argv[i_arg + 2]), ParseValue(argument, argv[i_arg + 3])) * transform;
+            i_arg += 3;
+        } else if (argument == "--translate") {
+            require(3);
+            transform = AffineTransform::Translation(ParseValue(argument, argv[i_arg + 1]), ParseValue(argument, argv[i_arg + 2]), ParseValue(argument, argv[i_arg + 3])) * transform;
+            i_arg += 3;
+        } else if (argument == "--rotate") {
+            require(2);
+            const double angle = ParseValue(argument, argv[i_arg + 2]) * M_PI / 180.0;
+            transform = AffineTransform::Rotation(ParseAxis(argv[i_arg + 1]), angle) * transform;
+            i_arg += 2;
+        } else if (argument == "--mirror") {
+            require(1);
+            transform = AffineTransform::Mirror(ParseAxis(argv[i_arg + 1])) * transform;
+            i_arg += 1;
+        } else if (argument == "--units") {
+            require(2);
+            transform = AffineTransform::Scale(GetUnitLength(argv[i_arg + 1]) / GetUnitLength(argv[i_arg + 2])) * transform;
+            i_arg += 2;
+        } else if (argument == "--matrix") {
+            require(16);
+            AffineTransform::Matrix matrix;
+            for (std::size_t i_component = 0; i_component < 16; ++i_component) {
+                matrix[i_component] = ParseValue(argument, argv[++i_arg]);
+            }
+            transform = AffineTransform(matrix) * transform;
+        } else if (argument.size() > 1 && argument.front() == '-' && !std::isdigit(argument[1]) && argument[1] != '.') {
+            std::cout << "Unrecognized option: " << argument << std::endl;
+            PrintUsage();
+            std::exit(-1);
+        } else {
+            positionals.push_back(argument);
+        }
+    }
+
+    if (positionals.size() == 3) {
+        transform = AffineTransform::Scale(ParseValue("the scaling factor", positionals.back())) * transform;
+        positionals.pop_back();
+    }
+
+    if (positionals.size() != 2) {
+        std::cout << "Please provide input mesh name and output mesh name without the .mdpa extension" << std::endl;
+        PrintUsage();
         std::exit(-1);
     }
 
-    const double scaling_factor = std::stod(argv[3]);
+    std::cout << "Input mesh name : " << positionals[0] << std::endl;
+    std::cout << "Output mesh name: " << positionals[1] << std::endl;
+    std::cout << "Transformation  :" << std::endl;
+    for (std::size_t i_row = 0; i_row < 4; ++i_row) {
+        std::cout << "   ";
+        for (std::size_t i_column = 0; i_column < 4; ++i_column) {
+            std::cout << " " << std::setw(12) << transform.GetMatrix()[4 * i_row + i_column];
+        }
+        std::cout << std::endl;
+    }
 
-    std::cout << "Input mesh name : " << argv[1] << std::endl;
-    std::cout << "Output mesh name: " << argv[2] << std::endl;
-    std::cout << "Scaling factor  : " << scaling_factor << std::endl;
+    if (stream) {
+        const std::filesystem::path input_path = positionals[0] + ".mdpa";
+        const std::filesystem::path output_path = positionals[1] + ".mdpa";
+        std::error_code error;
+        if (std::filesystem::equivalent(input_path, output_path, error)) {
+            std::cout << "Input and output must be different files in streaming mode." << std::endl;
+            std::exit(-1);
+        }
+        StreamTransform(input_path, output_path, transform);
+        return 0;
+    }
 
     auto p_structural_app = make_shared<KratosStructuralMechanicsApplication>();
     kernel.ImportApplication(p_structural_app);
 
     Model model;
-    auto& r_input_model_part = model.CreateModelPart(argv[1]);
-    ModelPartIO(argv[1]).ReadModelPart(r_input_model_part);
+    auto& r_input_model_part = model.CreateModelPart(positionals[0]);
+    ModelPartIO(positionals[0]).ReadModelPart(r_input_model_part);
 
     std::cout << "-------------- Input model part --------------" << std::endl << r_input_model_part << std::endl;
 
-    block_for_each(r_input_model_part.Nodes(), [scaling_factor](auto& rNode) { rNode.Coordinates() *= scaling_factor; });
+    TransformNodes(r_input_model_part, transform);
 
-    ModelPartIO(argv[2], ModelPartIO::WRITE).WriteModelPart(r_input_model_part);
+    ModelPartIO(positionals[1], ModelPartIO::WRITE).WriteModelPart(r_input_model_part);
     return 0;
-}
\ No newline at end of file
+}
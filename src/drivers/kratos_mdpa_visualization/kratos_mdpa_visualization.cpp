@@ -2,74 +2,1077 @@
 #include <iostream>
 #include <sstream>
 #include <filesystem>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <array>
+#include <functional>
+#include <utility>
+#include <cmath>
+#include <numeric>
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
 
 // Kratos includes
 #include "includes/kernel.h"
 #include "containers/model.h"
 #include "structural_mechanics_application.h"
-#include "input_output/vtu_output.h"
 #include "utilities/parallel_utilities.h"
-#include "includes/variables.h"
-#include "expression/container_expression.h"
-#include "expression/variable_expression_io.h"
+
+// Internal includes
+#include "KratosExecutables/VtuWriter.hpp"
+#include "KratosExecutables/ParallelSort.hpp"
 
 using namespace Kratos;
 
-void RecursiveOutput(ModelPart& rOutputModelPart)
+using Executables::VtuWriter;
+using Executables::ParallelSort;
+
+std::uint8_t GetVtkCellType(const Geometry<Node>& rGeometry)
+{
+    using Type = GeometryData::KratosGeometryType;
+    switch (rGeometry.GetGeometryType()) {
+        case Type::Kratos_Point2D:
+        case Type::Kratos_Point3D:              return 1;
+        case Type::Kratos_Line2D2:
+        case Type::Kratos_Line3D2:              return 3;
+        case Type::Kratos_Line2D3:
+        case Type::Kratos_Line3D3:              return 21;
+        case Type::Kratos_Triangle2D3:
+        case Type::Kratos_Triangle3D3:          return 5;
+        case Type::Kratos_Triangle2D6:
+        case Type::Kratos_Triangle3D6:          return 22;
+        case Type::Kratos_Quadrilateral2D4:
+        case Type::Kratos_Quadrilateral3D4:     return 9;
+        case Type::Kratos_Quadrilateral2D8:
+        case Type::Kratos_Quadrilateral3D8:     return 23;
+        case Type::Kratos_Quadrilateral2D9:
+        case Type::Kratos_Quadrilateral3D9:     return 28;
+        case Type::Kratos_Tetrahedra3D4:        return 10;
+        case Type::Kratos_Tetrahedra3D10:       return 24;
+        case Type::Kratos_Hexahedra3D8:         return 12;
+        case Type::Kratos_Hexahedra3D20:        return 25;
+        case Type::Kratos_Hexahedra3D27:        return 29;
+        case Type::Kratos_Prism3D6:             return 13;
+        case Type::Kratos_Prism3D15:            return 26;
+        case Type::Kratos_Pyramid3D5:           return 14;
+        default: KRATOS_ERROR << "unsupported geometry type of " << rGeometry.Info();
+    }
+}
+
+/// @brief Get the Kratos node index of each VTK node of a geometry, if the two orderings differ.
+/// @details Quadratic hexahedra: Kratos numbers the vertical mid-edge nodes 12-15 and the top ones 16-19,
+///          VTK the other way around. Face centers are ordered bottom, front, right, back, left, top in
+///          Kratos, and left, right, front, back, bottom, top in VTK. Quadratic prisms: Kratos numbers
+///          the vertical mid-edge nodes 9-11 and the top ones 12-14, VTK the other way around.
+/// @return nullptr if the orderings match.
+const std::uint8_t* GetVtkNodeOrder(const Geometry<Node>& rGeometry)
+{
+    static constexpr std::uint8_t hexahedron_20[] {
+        0, 1, 2, 3, 4, 5, 6, 7,
+        8, 9, 10, 11, 16, 17, 18, 19, 12, 13, 14, 15};
+    static constexpr std::uint8_t hexahedron_27[] {
+        0, 1, 2, 3, 4, 5, 6, 7,
+        8, 9, 10, 11, 16, 17, 18, 19, 12, 13, 14, 15,
+        24, 22, 21, 23, 20, 25, 26};
+    static constexpr std::uint8_t prism_15[] {
+        0, 1, 2, 3, 4, 5,
+        6, 7, 8, 12, 13, 14, 9, 10, 11};
+
+    using Type = GeometryData::KratosGeometryType;
+    switch (rGeometry.GetGeometryType()) {
+        case Type::Kratos_Hexahedra3D20:        return hexahedron_20;
+        case Type::Kratos_Hexahedra3D27:        return hexahedron_27;
+        case Type::Kratos_Prism3D15:            return prism_15;
+        default:                                return nullptr;
+    }
+}
+
+/// @brief Call a functor on each node of a geometry, in VTK's order.
+template<class TFunctor>
+void ForEachVtkNode(const Geometry<Node>& rGeometry, TFunctor&& rFunctor)
+{
+    const std::uint8_t* p_order = GetVtkNodeOrder(rGeometry);
+    for (std::size_t i_node = 0; i_node < rGeometry.size(); ++i_node) {
+        rFunctor(rGeometry[p_order ? p_order[i_node] : i_node]);
+    }
+}
+
+template<class TContainer>
+std::int64_t GetIndex(
+    const TContainer& rContainer,
+    const IndexType Id)
+{
+    const auto itr = rContainer.find(Id);
+    KRATOS_ERROR_IF(itr == rContainer.end()) << "entity " << Id << " is not in the root model part";
+    return std::distance(rContainer.begin(), itr);
+}
+
+template<class TContainer>
+void AppendCells(
+    std::vector<std::int64_t>& rConnectivity,
+    std::vector<std::int64_t>& rOffsets,
+    std::vector<std::uint8_t>& rTypes,
+    const TContainer& rEntities,
+    const ModelPart::NodesContainerType& rPoints)
+{
+    const std::size_t cell_begin = rOffsets.size();
+    rOffsets.resize(cell_begin + rEntities.size());
+    rTypes.resize(cell_begin + rEntities.size());
+
+    std::int64_t offset = rConnectivity.size();
+    for (std::size_t i_entity = 0; i_entity < rEntities.size(); ++i_entity) {
+        offset += (rEntities.begin() + i_entity)->GetGeometry().size();
+        rOffsets[cell_begin + i_entity] = offset;
+    }
+    rConnectivity.resize(offset);
+
+    IndexPartition<std::size_t>(rEntities.size()).for_each([&](const std::size_t Index) {
+        const auto& r_geometry = (rEntities.begin() + Index)->GetGeometry();
+        rTypes[cell_begin + Index] = GetVtkCellType(r_geometry);
+        auto itr = rConnectivity.begin() + rOffsets[cell_begin + Index] - r_geometry.size();
+        ForEachVtkNode(r_geometry, [&itr, &rPoints](const Node& rNode) {
+            *itr++ = GetIndex(rPoints, rNode.Id());
+        });
+    });
+}
+
+template<class TInteger, class TContainer>
+std::vector<TInteger> GatherIds(
+    const TContainer& rEntities,
+    const std::size_t Size,
+    const std::size_t Begin)
+{
+    std::vector<TInteger> ids(Size, 0);
+    IndexPartition<std::size_t>(rEntities.size()).for_each([&](const std::size_t Index) {
+        ids[Begin + Index] = static_cast<TInteger>((rEntities.begin() + Index)->Id());
+    });
+    return ids;
+}
+
+/// @brief Check whether any ID in a container exceeds the range of Int32.
+/// @details Containers are sorted by ID, so the largest one is looked up at the back.
+template<class TContainer>
+bool HasWideIds(const TContainer& rEntities)
+{
+    const IndexType max_id = rEntities.empty() ? 0 : (rEntities.end() - 1)->Id();
+    return static_cast<IndexType>(std::numeric_limits<std::int32_t>::max()) < max_id;
+}
+
+/// @brief Gather entity IDs into an integer array at [Begin, Begin + rEntities.size()), padded with zeros up to @p Size.
+/// @details IDs are written as Int32 if they fit, Int64 otherwise.
+template<class TContainer>
+VtuWriter::DataArray GetIds(
+    const TContainer& rEntities,
+    const std::size_t Size,
+    const std::size_t Begin)
+{
+    if (HasWideIds(rEntities)) {
+        return GatherIds<std::int64_t>(rEntities, Size, Begin);
+    } else {
+        return GatherIds<std::int32_t>(rEntities, Size, Begin);
+    }
+}
+
+template<class TContainer>
+VtuWriter::DataArray GetIds(const TContainer& rEntities)
+{
+    return GetIds(rEntities, rEntities.size(), 0);
+}
+
+template<class TContainer>
+std::vector<std::int64_t> GetIndices(
+    const TContainer& rEntities,
+    const TContainer& rRootEntities,
+    const std::int64_t Begin)
+{
+    std::vector<std::int64_t> indices(rEntities.size());
+    IndexPartition<std::size_t>(rEntities.size()).for_each([&](const std::size_t Index) {
+        indices[Index] = Begin + GetIndex(rRootEntities, (rEntities.begin() + Index)->Id());
+    });
+    return indices;
+}
+
+void AddSubModelPartIndices(
+    VtuWriter& rWriter,
+    const ModelPart& rModelPart)
+{
+    const auto& r_root_model_part = rModelPart.GetRootModelPart();
+
+    for (const auto& r_sub_model_part : rModelPart.SubModelParts()) {
+        const std::string prefix = r_sub_model_part.FullName();
+        rWriter.AddFieldData(prefix + ".point_indices", GetIndices(r_sub_model_part.Nodes(), r_root_model_part.Nodes(), 0));
+
+        auto cell_indices = GetIndices(r_sub_model_part.Elements(), r_root_model_part.Elements(), 0);
+        const auto condition_indices = GetIndices(r_sub_model_part.Conditions(), r_root_model_part.Conditions(), r_root_model_part.NumberOfElements());
+        cell_indices.insert(cell_indices.end(), condition_indices.begin(), condition_indices.end());
+        rWriter.AddFieldData(prefix + ".cell_indices", std::move(cell_indices));
+
+        AddSubModelPartIndices(rWriter, r_sub_model_part);
+    }
+}
+
+std::vector<double> GetCoordinates(const ModelPart::NodesContainerType& rNodes)
+{
+    std::vector<double> coordinates(3 * rNodes.size());
+    IndexPartition<std::size_t>(rNodes.size()).for_each([&](const std::size_t Index) {
+        const auto& r_node = *(rNodes.begin() + Index);
+        coordinates[3 * Index] = r_node.X0();
+        coordinates[3 * Index + 1] = r_node.Y0();
+        coordinates[3 * Index + 2] = r_node.Z0();
+    });
+    return coordinates;
+}
+
+/// @brief Interleave the bits of quantized coordinates into a 63 bit Morton key.
+std::uint64_t GetMortonKey(
+    const array_1d<double, 3>& rPoint,
+    const array_1d<double, 3>& rLowerBound,
+    const array_1d<double, 3>& rInverseExtent)
+{
+    constexpr std::uint64_t resolution = (1ul << 21) - 1;
+    std::uint64_t key = 0;
+    for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+        const double normalized = std::clamp((rPoint[i_dim] - rLowerBound[i_dim]) * rInverseExtent[i_dim], 0.0, 1.0);
+        const std::uint64_t quantized = static_cast<std::uint64_t>(normalized * resolution);
+        for (std::size_t i_bit = 0; i_bit < 21; ++i_bit) {
+            key |= ((quantized >> i_bit) & 1ul) << (3 * i_bit + i_dim);
+        }
+    }
+    return key;
+}
+
+/// @brief Sort cells along a Morton curve of their centers and split them into contiguous pieces of equal size.
+template<class TContainer>
+std::vector<std::vector<std::size_t>> PartitionCells(
+    const TContainer& rEntities,
+    const std::size_t NumberOfPieces)
 {
-    VtuOutput vtu_output(rOutputModelPart);
+    const std::size_t number_of_cells = rEntities.size();
 
-    ContainerExpression<ModelPart::NodesContainerType> node_ids(rOutputModelPart);
-    VariableExpressionIO::Read(node_ids, &STEP, false);
-    vtu_output.AddContainerExpression<ModelPart::NodesContainerType>("node_ids", node_ids.Clone());
+    std::vector<array_1d<double, 3>> centers(number_of_cells);
+    IndexPartition<std::size_t>(number_of_cells).for_each([&](const std::size_t Index) {
+        centers[Index] = (rEntities.begin() + Index)->GetGeometry().Center();
+    });
+
+    array_1d<double, 3> lower_bound(3, std::numeric_limits<double>::max());
+    array_1d<double, 3> upper_bound(3, std::numeric_limits<double>::lowest());
+    for (const auto& r_center : centers) {
+        for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+            lower_bound[i_dim] = std::min(lower_bound[i_dim], r_center[i_dim]);
+            upper_bound[i_dim] = std::max(upper_bound[i_dim], r_center[i_dim]);
+        }
+    }
+
+    array_1d<double, 3> inverse_extent;
+    for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+        const double extent = upper_bound[i_dim] - lower_bound[i_dim];
+        inverse_extent[i_dim] = extent > 0.0 ? 1.0 / extent : 0.0;
+    }
+
+    std::vector<std::pair<std::uint64_t, std::size_t>> keys(number_of_cells);
+    IndexPartition<std::size_t>(number_of_cells).for_each([&](const std::size_t Index) {
+        keys[Index] = std::make_pair(GetMortonKey(centers[Index], lower_bound, inverse_extent), Index);
+    });
+    ParallelSort(keys.begin(), keys.end());
+
+    std::vector<std::vector<std::size_t>> pieces(NumberOfPieces);
+    for (std::size_t i_piece = 0; i_piece < NumberOfPieces; ++i_piece) {
+        const std::size_t begin = i_piece * number_of_cells / NumberOfPieces;
+        const std::size_t end = (i_piece + 1) * number_of_cells / NumberOfPieces;
+        pieces[i_piece].reserve(end - begin);
+        for (std::size_t i_key = begin; i_key < end; ++i_key) {
+            pieces[i_piece].push_back(keys[i_key].second);
+        }
+    }
+
+    return pieces;
+}
+
+template<class TGetter>
+VtuWriter::DataArray MakeIdArray(
+    const std::size_t Size,
+    const bool WideIds,
+    TGetter&& rGetter)
+{
+    const auto gather = [Size, &rGetter](auto Prototype) {
+        using Integer = decltype(Prototype);
+        std::vector<Integer> ids(Size);
+        IndexPartition<std::size_t>(Size).for_each([&](const std::size_t Index) {
+            ids[Index] = static_cast<Integer>(rGetter(Index));
+        });
+        return VtuWriter::DataArray(std::move(ids));
+    };
+    return WideIds ? gather(std::int64_t()) : gather(std::int32_t());
+}
+
+/// @brief Sort nodes by ID and remove duplicates.
+std::vector<const Node*> GetUniqueNodes(std::vector<const Node*> Nodes)
+{
+    std::sort(Nodes.begin(), Nodes.end(), [](const Node* pLeft, const Node* pRight) { return pLeft->Id() < pRight->Id(); });
+    Nodes.erase(std::unique(Nodes.begin(), Nodes.end(), [](const Node* pLeft, const Node* pRight) { return pLeft->Id() == pRight->Id(); }), Nodes.end());
+    return Nodes;
+}
+
+std::int64_t GetLocalIndex(
+    const std::vector<const Node*>& rNodes,
+    const Node* pNode)
+{
+    const auto itr = std::lower_bound(rNodes.begin(), rNodes.end(), pNode, [](const Node* pLeft, const Node* pRight) { return pLeft->Id() < pRight->Id(); });
+    return std::distance(rNodes.begin(), itr);
+}
+
+/// @brief Set the points and cells of a writer from cells defined by node pointers.
+/// @details Referenced nodes and @p rExtraNodes become points. They are returned sorted by ID, in the order they were written.
+std::vector<const Node*> SetLocalMesh(
+    VtuWriter& rWriter,
+    const std::vector<const Node*>& rConnectivity,
+    std::vector<std::int64_t>&& rOffsets,
+    std::vector<std::uint8_t>&& rTypes,
+    const std::vector<const Node*>& rExtraNodes = {})
+{
+    std::vector<const Node*> points;
+    points.reserve(rConnectivity.size() + rExtraNodes.size());
+    points.insert(points.end(), rConnectivity.begin(), rConnectivity.end());
+    points.insert(points.end(), rExtraNodes.begin(), rExtraNodes.end());
+    const auto nodes = GetUniqueNodes(std::move(points));
+
+    std::vector<double> coordinates(3 * nodes.size());
+    IndexPartition<std::size_t>(nodes.size()).for_each([&](const std::size_t Index) {
+        coordinates[3 * Index] = nodes[Index]->X0();
+        coordinates[3 * Index + 1] = nodes[Index]->Y0();
+        coordinates[3 * Index + 2] = nodes[Index]->Z0();
+    });
+    rWriter.SetPoints(std::move(coordinates));
+
+    std::vector<std::int64_t> connectivity(rConnectivity.size());
+    IndexPartition<std::size_t>(rConnectivity.size()).for_each([&](const std::size_t Index) {
+        connectivity[Index] = GetLocalIndex(nodes, rConnectivity[Index]);
+    });
+    rWriter.SetCells(std::move(connectivity), std::move(rOffsets), std::move(rTypes));
+
+    return nodes;
+}
+
+/// @brief Write a subset of a container's entities and the nodes they refer to.
+/// @details The integer width of ID arrays is passed in to keep them consistent across pieces.
+/// @param rExtraNodes Nodes to write even if none of the cells refers to them.
+template<class TContainer>
+void WritePiece(
+    VtuWriter& rWriter,
+    const TContainer& rEntities,
+    const std::vector<std::size_t>& rCells,
+    const std::string& rIdName,
+    const bool WideNodeIds,
+    const bool WideCellIds,
+    const std::vector<const Node*>& rExtraNodes = {})
+{
+    std::vector<std::int64_t> offsets(rCells.size());
+    std::vector<std::uint8_t> types(rCells.size());
+    std::int64_t offset = 0;
+    for (std::size_t i_cell = 0; i_cell < rCells.size(); ++i_cell) {
+        offset += (rEntities.begin() + rCells[i_cell])->GetGeometry().size();
+        offsets[i_cell] = offset;
+    }
+
+    std::vector<const Node*> cell_nodes(offset);
+    IndexPartition<std::size_t>(rCells.size()).for_each([&](const std::size_t Index) {
+        const auto& r_geometry = (rEntities.begin() + rCells[Index])->GetGeometry();
+        types[Index] = GetVtkCellType(r_geometry);
+        auto itr = cell_nodes.begin() + offsets[Index] - r_geometry.size();
+        ForEachVtkNode(r_geometry, [&itr](const Node& rNode) {
+            *itr++ = &rNode;
+        });
+    });
+
+    const auto nodes = SetLocalMesh(rWriter, cell_nodes, std::move(offsets), std::move(types), rExtraNodes);
+
+    rWriter.AddPointData("node_ids", MakeIdArray(nodes.size(), WideNodeIds, [&nodes](const std::size_t Index) {
+        return nodes[Index]->Id();
+    }));
+    rWriter.AddCellData(rIdName, MakeIdArray(rCells.size(), WideCellIds, [&rEntities, &rCells](const std::size_t Index) {
+        return (rEntities.begin() + rCells[Index])->Id();
+    }));
+}
+
+/// @brief Write a model part's nodes and either its elements or, if it has none, its conditions.
+/// @details Nodes that the cells refer to are written as well, even if the model part does not list them.
+void ModelPartOutput(
+    const ModelPart& rOutputModelPart,
+    const VtuWriter::Format OutputFormat)
+{
+    const auto& r_nodes = rOutputModelPart.Nodes();
+    std::vector<const Node*> nodes(r_nodes.size());
+    IndexPartition<std::size_t>(r_nodes.size()).for_each([&](const std::size_t Index) {
+        nodes[Index] = &*(r_nodes.begin() + Index);
+    });
+    const bool wide_node_ids = HasWideIds(rOutputModelPart.GetRootModelPart().Nodes());
+
+    VtuWriter writer(OutputFormat);
+    const auto write = [&](const auto& rEntities, const std::string& rIdName) {
+        std::vector<std::size_t> cells(rEntities.size());
+        std::iota(cells.begin(), cells.end(), 0);
+        WritePiece(writer, rEntities, cells, rIdName, wide_node_ids, HasWideIds(rEntities), nodes);
+    };
 
     if (rOutputModelPart.NumberOfElements() > 0) {
-        ContainerExpression<ModelPart::ElementsContainerType> element_ids(rOutputModelPart);
-        VariableExpressionIO::Read(element_ids, &STEP);
-        vtu_output.AddContainerExpression<ModelPart::ElementsContainerType>("element_ids", element_ids.Clone());
-    } else if (rOutputModelPart.NumberOfConditions() > 0) {
-        ContainerExpression<ModelPart::ConditionsContainerType> condition_ids(rOutputModelPart);
-        VariableExpressionIO::Read(condition_ids, &STEP);
-        vtu_output.AddContainerExpression<ModelPart::ConditionsContainerType>("condition_ids", condition_ids.Clone());
+        write(rOutputModelPart.Elements(), "element_ids");
+    } else {
+        write(rOutputModelPart.Conditions(), "condition_ids");
     }
 
+    std::stringstream file_name;
+    file_name << rOutputModelPart.GetRootModelPart().FullName() << "/" << rOutputModelPart.FullName() << ".vtu";
+    writer.Write(file_name.str());
+}
+
+/// @brief Split a model part's output spatially into pieces and write them along with a *.pvtu index.
+/// @details Cells are elements or, if the model part has none, conditions. Pieces are written
+///          concurrently and contain only the nodes referenced by their cells.
+void PartitionedModelPartOutput(
+    const ModelPart& rOutputModelPart,
+    const VtuWriter::Format OutputFormat,
+    const std::size_t NumberOfPieces)
+{
+    const bool has_elements = rOutputModelPart.NumberOfElements() > 0;
+    const std::size_t number_of_cells = has_elements ? rOutputModelPart.NumberOfElements() : rOutputModelPart.NumberOfConditions();
+    const std::size_t number_of_pieces = std::min(NumberOfPieces, number_of_cells);
+
     std::stringstream file_name;
     file_name << rOutputModelPart.GetRootModelPart().FullName() << "/" << rOutputModelPart.FullName();
-    vtu_output.PrintOutput(file_name.str());
+    const std::filesystem::path prefix = file_name.str();
+
+    // Cells may refer to nodes the model part does not list.
+    const bool wide_node_ids = HasWideIds(rOutputModelPart.GetRootModelPart().Nodes());
+    const auto cells = has_elements
+                     ? PartitionCells(rOutputModelPart.Elements(), number_of_pieces)
+                     : PartitionCells(rOutputModelPart.Conditions(), number_of_pieces);
 
-    for (const auto& r_sub_model_part_name : rOutputModelPart.GetSubModelPartNames()) {
-        RecursiveOutput(rOutputModelPart.GetSubModelPart(r_sub_model_part_name));
+    std::vector<std::filesystem::path> piece_paths(number_of_pieces);
+    for (std::size_t i_piece = 0; i_piece < number_of_pieces; ++i_piece) {
+        piece_paths[i_piece] = prefix.filename().string() + "_" + std::to_string(i_piece) + ".vtu";
     }
+
+    std::vector<VtuWriter> writers;
+    writers.reserve(number_of_pieces);
+    for (std::size_t i_piece = 0; i_piece < number_of_pieces; ++i_piece) {
+        writers.emplace_back(OutputFormat);
+    }
+
+    IndexPartition<std::size_t>(number_of_pieces).for_each([&](const std::size_t Index) {
+        if (has_elements) {
+            WritePiece(writers[Index], rOutputModelPart.Elements(), cells[Index], "element_ids", wide_node_ids, HasWideIds(rOutputModelPart.Elements()));
+        } else {
+            WritePiece(writers[Index], rOutputModelPart.Conditions(), cells[Index], "condition_ids", wide_node_ids, HasWideIds(rOutputModelPart.Conditions()));
+        }
+        writers[Index].Write(prefix.parent_path() / piece_paths[Index]);
+
+        // Release the piece's arrays but keep the first writer for the index.
+        if (Index) {
+            writers[Index] = VtuWriter(OutputFormat);
+        }
+    });
+
+    writers.front().WriteIndex(prefix.string() + ".pvtu", piece_paths);
+}
+
+/// @brief Cells defined by node pointers, along with the IDs of the entities they originate from.
+struct CellSet
+{
+    std::vector<const Node*> mConnectivity;
+    std::vector<std::int64_t> mOffsets;
+    std::vector<std::uint8_t> mTypes;
+    std::vector<IndexType> mIds;
+};
+
+/// @brief Sorted IDs of a face's corner nodes, identifying it regardless of orientation and node order.
+using FaceKey = std::array<IndexType, 4>;
+
+FaceKey GetFaceKey(const Geometry<Node>& rFace)
+{
+    FaceKey key {0, 0, 0, 0};
+    const std::size_t number_of_corners = rFace.GetGeometryFamily() == GeometryData::KratosGeometryFamily::Kratos_Triangle ? 3 : 4;
+    for (std::size_t i_corner = 0; i_corner < number_of_corners; ++i_corner) {
+        key[i_corner] = rFace[i_corner].Id();
+    }
+    std::sort(key.begin(), key.begin() + number_of_corners);
+    return key;
+}
+
+/// @brief Collect the boundary faces of volume entities, and every other entity as it is.
+/// @details Faces of all volume entities are generated once and sorted by their keys in parallel.
+///          Faces whose key appears only once are not shared by two entities, so they are on the boundary.
+template<class TContainer>
+CellSet ExtractSurface(const TContainer& rEntities)
+{
+    struct FaceRecord
+    {
+        FaceKey mKey;
+        std::size_t mEntity;
+        std::size_t mFace; // index in face_geometries
+    };
+
+    const std::size_t number_of_entities = rEntities.size();
+
+    std::vector<std::size_t> face_begins(number_of_entities + 1, 0);
+    std::vector<std::size_t> surface_entities;
+    for (std::size_t i_entity = 0; i_entity < number_of_entities; ++i_entity) {
+        const auto& r_geometry = (rEntities.begin() + i_entity)->GetGeometry();
+        const bool is_volume = r_geometry.LocalSpaceDimension() == 3;
+        face_begins[i_entity + 1] = face_begins[i_entity] + (is_volume ? r_geometry.FacesNumber() : 0);
+        if (!is_volume) {
+            surface_entities.push_back(i_entity);
+        }
+    }
+
+    std::vector<FaceRecord> faces(face_begins.back());
+    std::vector<Geometry<Node>::Pointer> face_geometries(face_begins.back());
+    IndexPartition<std::size_t>(number_of_entities).for_each([&](const std::size_t Index) {
+        const auto& r_geometry = (rEntities.begin() + Index)->GetGeometry();
+        if (r_geometry.LocalSpaceDimension() == 3) {
+            const auto generated_faces = r_geometry.GenerateFaces();
+            for (std::size_t i_face = 0; i_face < generated_faces.size(); ++i_face) {
+                const std::size_t i_record = face_begins[Index] + i_face;
+                faces[i_record] = FaceRecord {GetFaceKey(generated_faces[i_face]), Index, i_record};
+                face_geometries[i_record] = generated_faces(i_face);
+            }
+        }
+    });
+    ParallelSort(faces.begin(), faces.end(), [](const FaceRecord& rLeft, const FaceRecord& rRight) { return rLeft.mKey < rRight.mKey; });
+
+    std::vector<const FaceRecord*> boundary_faces;
+    for (auto itr = faces.begin(); itr != faces.end();) {
+        auto itr_end = std::find_if(itr, faces.end(), [itr](const FaceRecord& rFace) { return rFace.mKey != itr->mKey; });
+        if (std::distance(itr, itr_end) == 1) {
+            boundary_faces.push_back(&*itr);
+        }
+        itr = itr_end;
+    }
+
+    std::vector<Geometry<Node>::Pointer> boundary_geometries(boundary_faces.size());
+    IndexPartition<std::size_t>(boundary_faces.size()).for_each([&](const std::size_t Index) {
+        boundary_geometries[Index] = std::move(face_geometries[boundary_faces[Index]->mFace]);
+    });
+    face_geometries = {};
+
+    const std::size_t number_of_cells = boundary_faces.size() + surface_entities.size();
+    const auto get_geometry = [&](const std::size_t Index) -> const Geometry<Node>& {
+        return Index < boundary_faces.size()
+             ? *boundary_geometries[Index]
+             : (rEntities.begin() + surface_entities[Index - boundary_faces.size()])->GetGeometry();
+    };
+
+    CellSet output;
+    output.mOffsets.resize(number_of_cells);
+    output.mTypes.resize(number_of_cells);
+    output.mIds.resize(number_of_cells);
+
+    std::int64_t offset = 0;
+    for (std::size_t i_cell = 0; i_cell < number_of_cells; ++i_cell) {
+        offset += get_geometry(i_cell).size();
+        output.mOffsets[i_cell] = offset;
+    }
+    output.mConnectivity.resize(offset);
+
+    IndexPartition<std::size_t>(number_of_cells).for_each([&](const std::size_t Index) {
+        const auto& r_geometry = get_geometry(Index);
+        output.mTypes[Index] = GetVtkCellType(r_geometry);
+        output.mIds[Index] = Index < boundary_faces.size()
+                           ? (rEntities.begin() + boundary_faces[Index]->mEntity)->Id()
+                           : (rEntities.begin() + surface_entities[Index - boundary_faces.size()])->Id();
+        auto itr = output.mConnectivity.begin() + output.mOffsets[Index] - r_geometry.size();
+        ForEachVtkNode(r_geometry, [&itr](const Node& rNode) {
+            *itr++ = &rNode;
+        });
+    });
+
+    return output;
+}
+
+/// @brief Triangulated surface with points of its own, as produced by decimation.
+struct TriangleSurface
+{
+    std::vector<array_1d<double, 3>> mPoints;
+    std::vector<IndexType> mPointIds;
+    std::vector<std::array<std::int64_t, 3>> mTriangles;
+    std::vector<IndexType> mTriangleIds;
+};
+
+/// @brief Split surface cells into linear triangles, dropping lines and points.
+TriangleSurface Triangulate(const CellSet& rCells)
+{
+    const auto nodes = GetUniqueNodes(rCells.mConnectivity);
+
+    TriangleSurface output;
+    output.mPoints.resize(nodes.size());
+    output.mPointIds.resize(nodes.size());
+    IndexPartition<std::size_t>(nodes.size()).for_each([&](const std::size_t Index) {
+        output.mPoints[Index] = nodes[Index]->GetInitialPosition();
+        output.mPointIds[Index] = nodes[Index]->Id();
+    });
+
+    for (std::size_t i_cell = 0; i_cell < rCells.mTypes.size(); ++i_cell) {
+        const auto itr_begin = rCells.mConnectivity.begin() + (i_cell ? rCells.mOffsets[i_cell - 1] : 0);
+        const auto local_index = [&nodes, itr_begin](const std::size_t iNode) { return GetLocalIndex(nodes, *(itr_begin + iNode)); };
+        switch (rCells.mTypes[i_cell]) {
+            case 5:     // triangle
+            case 22:    // quadratic triangle
+                output.mTriangles.push_back({local_index(0), local_index(1), local_index(2)});
+                output.mTriangleIds.push_back(rCells.mIds[i_cell]);
+                break;
+            case 9:     // quadrilateral
+            case 23:    // quadratic quadrilateral
+            case 28:    // biquadratic quadrilateral
+                output.mTriangles.push_back({local_index(0), local_index(1), local_index(2)});
+                output.mTriangles.push_back({local_index(0), local_index(2), local_index(3)});
+                output.mTriangleIds.push_back(rCells.mIds[i_cell]);
+                output.mTriangleIds.push_back(rCells.mIds[i_cell]);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return output;
+}
+
+/// @brief Merge all points within the same cell of a uniform grid into their centroid.
+/// @details Triangles that collapse into lines or points are dropped, and duplicates are removed.
+TriangleSurface ClusterVertices(
+    const TriangleSurface& rSurface,
+    const array_1d<double, 3>& rLowerBound,
+    const double CellSize,
+    const std::array<std::uint64_t, 3>& rGridSize)
+{
+    const std::size_t number_of_points = rSurface.mPoints.size();
+
+    std::vector<std::pair<std::uint64_t, std::size_t>> keys(number_of_points);
+    IndexPartition<std::size_t>(number_of_points).for_each([&](const std::size_t Index) {
+        std::uint64_t key = 0;
+        for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+            const std::uint64_t i_cell = static_cast<std::uint64_t>((rSurface.mPoints[Index][i_dim] - rLowerBound[i_dim]) / CellSize);
+            key = key * rGridSize[i_dim] + std::min(i_cell, rGridSize[i_dim] - 1);
+        }
+        keys[Index] = std::make_pair(key, Index);
+    });
+    ParallelSort(keys.begin(), keys.end());
+
+    TriangleSurface output;
+    std::vector<std::int64_t> clusters(number_of_points);
+    for (auto itr = keys.begin(); itr != keys.end();) {
+        const auto itr_end = std::find_if(itr, keys.end(), [itr](const auto& rKey) { return rKey.first != itr->first; });
+        array_1d<double, 3> centroid = ZeroVector(3);
+        IndexType id = std::numeric_limits<IndexType>::max();
+        for (auto itr_member = itr; itr_member != itr_end; ++itr_member) {
+            centroid += rSurface.mPoints[itr_member->second];
+            id = std::min(id, rSurface.mPointIds[itr_member->second]);
+            clusters[itr_member->second] = output.mPoints.size();
+        }
+        output.mPoints.push_back(centroid / static_cast<double>(std::distance(itr, itr_end)));
+        output.mPointIds.push_back(id);
+        itr = itr_end;
+    }
+
+    std::vector<std::pair<std::array<std::int64_t, 3>, std::size_t>> triangles;
+    triangles.reserve(rSurface.mTriangles.size());
+    for (std::size_t i_triangle = 0; i_triangle < rSurface.mTriangles.size(); ++i_triangle) {
+        std::array<std::int64_t, 3> triangle;
+        for (std::size_t i_node = 0; i_node < 3; ++i_node) {
+            triangle[i_node] = clusters[rSurface.mTriangles[i_triangle][i_node]];
+        }
+        if (triangle[0] != triangle[1] && triangle[1] != triangle[2] && triangle[2] != triangle[0]) {
+            std::array<std::int64_t, 3> sorted_triangle = triangle;
+            std::sort(sorted_triangle.begin(), sorted_triangle.end());
+            triangles.emplace_back(sorted_triangle, i_triangle);
+        }
+    }
+    ParallelSort(triangles.begin(), triangles.end());
+    triangles.erase(std::unique(triangles.begin(), triangles.end(), [](const auto& rLeft, const auto& rRight) { return rLeft.first == rRight.first; }), triangles.end());
+
+    output.mTriangles.reserve(triangles.size());
+    output.mTriangleIds.reserve(triangles.size());
+    for (const auto& r_triangle : triangles) {
+        std::array<std::int64_t, 3> triangle;
+        for (std::size_t i_node = 0; i_node < 3; ++i_node) {
+            triangle[i_node] = clusters[rSurface.mTriangles[r_triangle.second][i_node]];
+        }
+        output.mTriangles.push_back(triangle);
+        output.mTriangleIds.push_back(rSurface.mTriangleIds[r_triangle.second]);
+    }
+
+    return output;
+}
+
+/// @brief Reduce the number of triangles to at most about @p TargetTriangles by vertex clustering.
+/// @details The grid resolution is estimated from the assumption that a surface occupies a number
+///          of grid cells proportional to the square of the resolution, then corrected a few times
+///          based on the number of triangles the previous resolution produced.
+TriangleSurface Decimate(
+    TriangleSurface&& rSurface,
+    const std::size_t TargetTriangles)
+{
+    if (rSurface.mTriangles.size() <= TargetTriangles || rSurface.mPoints.empty()) {
+        return std::move(rSurface);
+    }
+
+    array_1d<double, 3> lower_bound = rSurface.mPoints.front();
+    array_1d<double, 3> upper_bound = rSurface.mPoints.front();
+    for (const auto& r_point : rSurface.mPoints) {
+        for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+            lower_bound[i_dim] = std::min(lower_bound[i_dim], r_point[i_dim]);
+            upper_bound[i_dim] = std::max(upper_bound[i_dim], r_point[i_dim]);
+        }
+    }
+    const array_1d<double, 3> extent = upper_bound - lower_bound;
+    const double longest_extent = *std::max_element(extent.begin(), extent.end());
+    if (longest_extent <= 0.0) {
+        return std::move(rSurface);
+    }
+
+    constexpr std::size_t max_resolution = 1 << 20;
+    double resolution = std::sqrt(0.5 * TargetTriangles);
+    TriangleSurface output;
+    bool has_output = false;
+
+    for (std::size_t i_iteration = 0; i_iteration < 8; ++i_iteration) {
+        const std::size_t grid_resolution = std::clamp<std::size_t>(static_cast<std::size_t>(std::round(resolution)), 1, max_resolution);
+        const double cell_size = longest_extent / grid_resolution;
+        std::array<std::uint64_t, 3> grid_size;
+        for (std::size_t i_dim = 0; i_dim < 3; ++i_dim) {
+            grid_size[i_dim] = static_cast<std::uint64_t>(extent[i_dim] / cell_size) + 1;
+        }
+
+        auto candidate = ClusterVertices(rSurface, lower_bound, cell_size, grid_size);
+        const std::size_t number_of_triangles = candidate.mTriangles.size();
+
+        // Keep the finest candidate that satisfies the target, or the coarsest one if none does.
+        if (number_of_triangles <= TargetTriangles) {
+            if (!has_output || output.mTriangles.size() < number_of_triangles || TargetTriangles < output.mTriangles.size()) {
+                output = std::move(candidate);
+                has_output = true;
+            }
+            if (0.9 * TargetTriangles <= number_of_triangles) break;
+        } else if (!has_output || number_of_triangles < output.mTriangles.size()) {
+            output = std::move(candidate);
+            has_output = true;
+        }
+
+        resolution *= std::sqrt(static_cast<double>(TargetTriangles) / std::max<std::size_t>(number_of_triangles, 1));
+    }
+
+    return output;
+}
+
+/// @brief Write the surface of a model part's elements or, if it has none, its conditions.
+/// @details Volume entities are reduced to their boundary faces; all other entities are written as they are.
+///          If @p TargetTriangles is not 0, the surface is triangulated and decimated to about that many triangles.
+void SurfaceModelPartOutput(
+    const ModelPart& rOutputModelPart,
+    const VtuWriter::Format OutputFormat,
+    const std::size_t TargetTriangles)
+{
+    const bool has_elements = rOutputModelPart.NumberOfElements() > 0;
+    const std::string id_name = has_elements ? "element_ids" : "condition_ids";
+    const bool wide_node_ids = HasWideIds(rOutputModelPart.Nodes());
+    const bool wide_cell_ids = has_elements ? HasWideIds(rOutputModelPart.Elements()) : HasWideIds(rOutputModelPart.Conditions());
+
+    auto cells = has_elements ? ExtractSurface(rOutputModelPart.Elements()) : ExtractSurface(rOutputModelPart.Conditions());
+
+    VtuWriter writer(OutputFormat);
+
+    if (TargetTriangles) {
+        const auto surface = Decimate(Triangulate(cells), TargetTriangles);
+
+        std::vector<double> coordinates(3 * surface.mPoints.size());
+        for (std::size_t i_point = 0; i_point < surface.mPoints.size(); ++i_point) {
+            std::copy(surface.mPoints[i_point].begin(), surface.mPoints[i_point].end(), coordinates.begin() + 3 * i_point);
+        }
+        writer.SetPoints(std::move(coordinates));
+
+        std::vector<std::int64_t> connectivity, offsets;
+        connectivity.reserve(3 * surface.mTriangles.size());
+        offsets.reserve(surface.mTriangles.size());
+        for (const auto& r_triangle : surface.mTriangles) {
+            connectivity.insert(connectivity.end(), r_triangle.begin(), r_triangle.end());
+            offsets.push_back(connectivity.size());
+        }
+        writer.SetCells(std::move(connectivity), std::move(offsets), std::vector<std::uint8_t>(surface.mTriangles.size(), 5));
+
+        writer.AddPointData("node_ids", MakeIdArray(surface.mPointIds.size(), wide_node_ids, [&surface](const std::size_t Index) {
+            return surface.mPointIds[Index];
+        }));
+        writer.AddCellData(id_name, MakeIdArray(surface.mTriangleIds.size(), wide_cell_ids, [&surface](const std::size_t Index) {
+            return surface.mTriangleIds[Index];
+        }));
+    } else {
+        const auto nodes = SetLocalMesh(writer, cells.mConnectivity, std::move(cells.mOffsets), std::move(cells.mTypes));
+        writer.AddPointData("node_ids", MakeIdArray(nodes.size(), wide_node_ids, [&nodes](const std::size_t Index) {
+            return nodes[Index]->Id();
+        }));
+        writer.AddCellData(id_name, MakeIdArray(cells.mIds.size(), wide_cell_ids, [&cells](const std::size_t Index) {
+            return cells.mIds[Index];
+        }));
+    }
+
+    std::stringstream file_name;
+    file_name << rOutputModelPart.GetRootModelPart().FullName() << "/" << rOutputModelPart.FullName() << "_surface.vtu";
+    writer.Write(file_name.str());
+}
+
+void CollectModelParts(
+    std::vector<const ModelPart*>& rOutput,
+    const ModelPart& rModelPart)
+{
+    rOutput.push_back(&rModelPart);
+    for (const auto& r_sub_model_part : rModelPart.SubModelParts()) {
+        CollectModelParts(rOutput, r_sub_model_part);
+    }
+}
+
+/// @brief Write every model part of the tree into a separate file.
+/// @details Files are written concurrently by at most @p NumberOfJobs worker threads, each of
+///          which holds a single output at a time to keep the memory footprint bounded. The
+///          largest model parts are scheduled first so that they do not end up on the tail.
+///          The writers run parallel loops of their own, so the threads of @ref ParallelUtilities
+///          are split between workers instead of each worker starting a full team.
+/// @param rOutput Writes a single model part.
+void RecursiveOutput(
+    const ModelPart& rOutputModelPart,
+    const std::size_t NumberOfJobs,
+    const std::function<void(const ModelPart&)>& rOutput)
+{
+    std::vector<const ModelPart*> model_parts;
+    CollectModelParts(model_parts, rOutputModelPart);
+
+    std::stable_sort(model_parts.begin(), model_parts.end(), [](const ModelPart* pLeft, const ModelPart* pRight) {
+        return pLeft->NumberOfNodes() + pLeft->NumberOfElements() + pLeft->NumberOfConditions()
+             > pRight->NumberOfNodes() + pRight->NumberOfElements() + pRight->NumberOfConditions();
+    });
+
+    const std::size_t number_of_workers = std::max<std::size_t>(1, std::min(NumberOfJobs, model_parts.size()));
+    std::atomic<std::size_t> next_model_part(0);
+    std::vector<std::exception_ptr> errors(number_of_workers);
+
+    // The thread count of ParallelUtilities is global, and set once here. OpenMP's is per thread,
+    // so each worker sets its own.
+    const int number_of_threads = ParallelUtilities::GetNumThreads();
+    const int threads_per_worker = std::max(1, number_of_threads / static_cast<int>(number_of_workers));
+    ParallelUtilities::SetNumThreads(threads_per_worker);
+
+    const auto worker = [&model_parts, &next_model_part, &errors, &rOutput, threads_per_worker](const std::size_t WorkerIndex) {
+        try {
+            #ifdef _OPENMP
+            omp_set_num_threads(threads_per_worker);
+            #endif
+            for (std::size_t i = next_model_part++; i < model_parts.size(); i = next_model_part++) {
+                rOutput(*model_parts[i]);
+            }
+        } catch (...) {
+            errors[WorkerIndex] = std::current_exception();
+            next_model_part = model_parts.size();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t i_worker = 1; i_worker < number_of_workers; ++i_worker) {
+        workers.emplace_back(worker, i_worker);
+    }
+    worker(0);
+
+    for (auto& r_worker : workers) {
+        r_worker.join();
+    }
+    ParallelUtilities::SetNumThreads(number_of_threads);
+
+    for (const auto& rp_error : errors) {
+        if (rp_error) {
+            std::rethrow_exception(rp_error);
+        }
+    }
+}
+
+/// @brief Write the whole model part tree into a single file.
+/// @details Points of the root model part are written once, followed by all elements and conditions
+///          as cells. Sub model parts are represented by field data arrays "<full name>.point_indices"
+///          and "<full name>.cell_indices" that index into the points and cells of the root.
+void SingleFileOutput(
+    const ModelPart& rModelPart,
+    const VtuWriter::Format OutputFormat)
+{
+    const auto& r_nodes = rModelPart.Nodes();
+    const std::size_t number_of_cells = rModelPart.NumberOfElements() + rModelPart.NumberOfConditions();
+
+    VtuWriter writer(OutputFormat);
+    writer.SetPoints(GetCoordinates(r_nodes));
+
+    std::vector<std::int64_t> connectivity, offsets;
+    std::vector<std::uint8_t> types;
+    AppendCells(connectivity, offsets, types, rModelPart.Elements(), r_nodes);
+    AppendCells(connectivity, offsets, types, rModelPart.Conditions(), r_nodes);
+    writer.SetCells(std::move(connectivity), std::move(offsets), std::move(types));
+
+    writer.AddPointData("node_ids", GetIds(r_nodes));
+    writer.AddCellData("element_ids", GetIds(rModelPart.Elements(), number_of_cells, 0));
+    writer.AddCellData("condition_ids", GetIds(rModelPart.Conditions(), number_of_cells, rModelPart.NumberOfElements()));
+
+    AddSubModelPartIndices(writer, rModelPart);
+
+    std::stringstream file_name;
+    file_name << rModelPart.FullName() << "/" << rModelPart.FullName() << ".vtu";
+    writer.Write(file_name.str());
+}
+
+void PrintUsage()
+{
+    std::cout << "Usage: kratos_mdpa_visualization [options] input_mesh_name" << std::endl
+              << "The input mesh name must be provided without the .mdpa extension." << std::endl
+              << "Options:" << std::endl
+              << "    --single-file : write all sub model parts into one file, with the points of" << std::endl
+              << "                    the root model part written only once." << std::endl
+              << "    --jobs <n>    : number of sub model part files written concurrently (default: 1)." << std::endl
+              << "                    0 uses one job per hardware thread." << std::endl
+              << "    --pieces <n>  : split each sub model part's output spatially into n pieces" << std::endl
+              << "                    written in parallel, plus a *.pvtu index (default: 1)." << std::endl
+              << "                    Not supported with --single-file." << std::endl
+              << "    --preview     : write only the boundary faces of volume elements, along with" << std::endl
+              << "                    all other elements, into *_surface.vtu files." << std::endl
+              << "    --preview-triangles <n> : like --preview, but decimate each surface to about n triangles." << std::endl
+              << "    --format <f>  : data format of the output files (default: binary)." << std::endl
+              << "                    ascii  : human readable text." << std::endl
+              << "                    binary : base64 encoded inline binary data." << std::endl
+              << "                    raw    : raw binary data appended to the end of the file." << std::endl
+              << "                    zlib   : zlib compressed raw binary data appended to the end of the file." << std::endl
+              << "                    lz4    : lz4 compressed raw binary data appended to the end of the file." << std::endl;
+}
+
+/// @brief Parse the value of an option that takes a non-negative integer, or print the usage and exit.
+std::size_t ParseCount(
+    const std::string& rOption,
+    const std::string& rValue)
+{
+    try {
+        std::size_t end = 0;
+        const unsigned long value = std::stoul(rValue, &end);
+        if (end == rValue.size() && rValue.find('-') == std::string::npos) {
+            return value;
+        }
+    } catch (const std::logic_error&) {
+    }
+    std::cout << "Invalid value for " << rOption << ": " << rValue << std::endl;
+    PrintUsage();
+    std::exit(-1);
 }
 
 int main(int argc, char *argv[])
 {
     Kernel kernel;
 
-    if (argc != 2) {
+    bool single_file = false;
+    std::size_t number_of_jobs = 1;
+    std::size_t number_of_pieces = 1;
+    bool surface_preview = false;
+    std::size_t preview_triangles = 0;
+    VtuWriter::Format output_format = VtuWriter::Format::Binary;
+    std::vector<std::string> positional_arguments;
+    for (int i_arg = 1; i_arg < argc; ++i_arg) {
+        const std::string argument = argv[i_arg];
+        if (argument == "--single-file") {
+            single_file = true;
+        } else if (argument == "--jobs" && i_arg + 1 < argc) {
+            number_of_jobs = ParseCount(argument, argv[++i_arg]);
+            if (number_of_jobs == 0) {
+                number_of_jobs = std::max(1u, std::thread::hardware_concurrency());
+            }
+        } else if (argument == "--pieces" && i_arg + 1 < argc) {
+            number_of_pieces = std::max<std::size_t>(1, ParseCount(argument, argv[++i_arg]));
+        } else if (argument == "--preview") {
+            surface_preview = true;
+        } else if (argument == "--preview-triangles" && i_arg + 1 < argc) {
+            surface_preview = true;
+            preview_triangles = ParseCount(argument, argv[++i_arg]);
+        } else if (argument == "--format" && i_arg + 1 < argc) {
+            const std::string format = argv[++i_arg];
+            if (format == "ascii") {
+                output_format = VtuWriter::Format::ASCII;
+            } else if (format == "binary") {
+                output_format = VtuWriter::Format::Binary;
+            } else if (format == "raw") {
+                output_format = VtuWriter::Format::RawAppended;
+            } else if (format == "zlib") {
+                output_format = VtuWriter::Format::ZLibAppended;
+            } else if (format == "lz4") {
+                output_format = VtuWriter::Format::LZ4Appended;
+            } else {
+                std::cout << "Unknown output format: " << format << std::endl;
+                PrintUsage();
+                std::exit(-1);
+            }
+        } else if (argument == "-h" || argument == "--help") {
+            PrintUsage();
+            return 0;
+        } else if (argument.rfind("--", 0) == 0) {
+            std::cout << "Unknown option: " << argument << std::endl;
+            PrintUsage();
+            std::exit(-1);
+        } else {
+            positional_arguments.push_back(argument);
+        }
+    }
+
+    if (positional_arguments.size() != 1) {
         std::cout << "Please provide input mesh name without the .mdpa extension." << std::endl;
+        PrintUsage();
         std::exit(-1);
     }
 
-    std::cout << "Input mesh name : " << argv[1] << std::endl;
+    if (single_file && number_of_pieces > 1) {
+        std::cout << "--pieces cannot be combined with --single-file." << std::endl;
+        std::exit(-1);
+    }
+
+    if (surface_preview && (single_file || number_of_pieces > 1)) {
+        std::cout << "--preview cannot be combined with --single-file or --pieces." << std::endl;
+        std::exit(-1);
+    }
+
+    const std::string& r_input_name = positional_arguments.front();
+    std::cout << "Input mesh name : " << r_input_name << std::endl;
 
     auto p_structural_app = make_shared<KratosStructuralMechanicsApplication>();
     kernel.ImportApplication(p_structural_app);
 
     Model model;
-    auto& r_input_model_part = model.CreateModelPart(argv[1]);
-    ModelPartIO(argv[1]).ReadModelPart(r_input_model_part);
+    auto& r_input_model_part = model.CreateModelPart(r_input_name);
+    ModelPartIO(r_input_name).ReadModelPart(r_input_model_part);
 
     std::cout << "-------------- Input model part --------------" << std::endl << r_input_model_part << std::endl;
 
-    block_for_each(r_input_model_part.Nodes(), [](auto& rNode) { rNode.SetValue(STEP, rNode.Id()); });
-    block_for_each(r_input_model_part.Conditions(), [](auto& rCondition) { rCondition.SetValue(STEP, rCondition.Id()); });
-    block_for_each(r_input_model_part.Elements(), [](auto& rElement) { rElement.SetValue(STEP, rElement.Id()); });
-
     if (!std::filesystem::is_directory(r_input_model_part.FullName())) {
         std::filesystem::create_directory(r_input_model_part.FullName());
     }
 
-    RecursiveOutput(r_input_model_part);
+    if (single_file) {
+        SingleFileOutput(r_input_model_part, output_format);
+    } else if (surface_preview) {
+        RecursiveOutput(r_input_model_part, number_of_jobs, [output_format, preview_triangles](const ModelPart& rModelPart) {
+            SurfaceModelPartOutput(rModelPart, output_format, preview_triangles);
+        });
+    } else {
+        RecursiveOutput(r_input_model_part, number_of_jobs, [output_format, number_of_pieces](const ModelPart& rModelPart) {
+            if (1 < number_of_pieces && (rModelPart.NumberOfElements() || rModelPart.NumberOfConditions())) {
+                PartitionedModelPartOutput(rModelPart, output_format, number_of_pieces);
+            } else {
+                ModelPartOutput(rModelPart, output_format);
+            }
+        });
+    }
+
     return 0;
-}
\ No newline at end of file
+}
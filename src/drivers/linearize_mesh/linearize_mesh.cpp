@@ -7,12 +7,16 @@
 #include "geometries/geometry.h" // Geometry
 #include "geometries/geometry_data.h" // GeometryData
 #include "includes/kratos_application.h" // KratosApplication
+#include "utilities/parallel_utilities.h" // block_for_each, IndexPartition
 
 // --- STL Includes ---
 #include <iostream> // std::cout, std::cerr
 #include <vector> // std::vector
 #include <filesystem> // std::filesystem::path, std::filesystem::exists, std::filesystem::is_directory
 #include <memory> // std::unique_ptr
+#include <atomic> // std::atomic
+#include <iterator> // std::distance
+#include <string> // std::string
 
 
 void CheckRegisteredGeometry(const std::string& rGeometryName)
@@ -32,10 +36,6 @@ void ProcessModelTree(const Kratos::ModelPart& rSourceTree,
         ProcessModelTree(r_source_child, r_target_child);
     } // for r_source_child in rSourceTree.SubModelParts
 
-    // Copy nodes.
-    rTargetTree.AddNodes(rSourceTree.Nodes().begin(),
-                         rSourceTree.Nodes().end());
-
     // Convert geometries to their linear counterparts.
     for (const auto& r_geometry : rSourceTree.Geometries()) {
         switch (r_geometry.GetGeometryFamily()) {
@@ -89,13 +89,110 @@ void ProcessModelTree(const Kratos::ModelPart& rSourceTree,
 }
 
 
+/// @brief Flag the nodes of the root model part that are referenced by at least one geometry of the target tree.
+/// @details Flags are indexed by the nodes' positions in the root model part's node container.
+std::vector<std::atomic<bool>> MarkReferencedNodes(const Kratos::ModelPart& rSourceRoot,
+                                                   const Kratos::ModelPart& rTargetRoot)
+{
+    const auto& r_nodes = rSourceRoot.Nodes();
+    std::vector<std::atomic<bool>> referenced(r_nodes.size());
+
+    Kratos::block_for_each(rTargetRoot.Geometries(), [&r_nodes, &referenced](const auto& r_geometry) {
+        for (const auto& r_node : r_geometry) {
+            const auto it_node = r_nodes.find(r_node.Id());
+            KRATOS_DEBUG_ERROR_IF(it_node == r_nodes.end()) << "node " << r_node.Id() << " is not in the root model part";
+            referenced[std::distance(r_nodes.begin(), it_node)].store(true, std::memory_order_relaxed);
+        }
+    });
+
+    return referenced;
+}
+
+
+/// @brief Copy nodes from the source tree to the target tree, optionally skipping unreferenced ones.
+/// @param pReferenced Flags from @ref MarkReferencedNodes, or @p nullptr if all nodes should be copied.
+void CopyNodes(const Kratos::ModelPart& rSourceRoot,
+               const Kratos::ModelPart& rSourceTree,
+               Kratos::ModelPart& rTargetTree,
+               const std::vector<std::atomic<bool>>* pReferenced)
+{
+    for (const Kratos::ModelPart& r_source_child : rSourceTree.SubModelParts()) {
+        CopyNodes(rSourceRoot,
+                  r_source_child,
+                  rTargetTree.GetSubModelPart(r_source_child.Name()),
+                  pReferenced);
+    } // for r_source_child in rSourceTree.SubModelParts
+
+    if (pReferenced) {
+        const auto& r_root_nodes = rSourceRoot.Nodes();
+        std::vector<Kratos::Node::Pointer> nodes;
+        nodes.reserve(rSourceTree.NumberOfNodes());
+        for (auto it_node=rSourceTree.Nodes().ptr_begin(); it_node!=rSourceTree.Nodes().ptr_end(); ++it_node) {
+            const auto it_root_node = r_root_nodes.find((*it_node)->Id());
+            if ((*pReferenced)[std::distance(r_root_nodes.begin(), it_root_node)].load(std::memory_order_relaxed)) {
+                nodes.push_back(*it_node);
+            }
+        } // for p_node in rSourceTree.Nodes()
+        rTargetTree.AddNodes(nodes.begin(), nodes.end());
+    } else {
+        rTargetTree.AddNodes(rSourceTree.Nodes().begin(),
+                             rSourceTree.Nodes().end());
+    }
+}
+
+
+/// @brief Assign consecutive IDs starting at 1 to the nodes of the target tree.
+/// @details The new IDs preserve the relative order of the old ones, so the sorted
+///          node containers of sub model parts remain valid without resorting.
+/// @warning Nodes are shared with the source tree, whose containers are invalidated.
+void RenumberNodes(Kratos::ModelPart& rTargetRoot)
+{
+    auto& r_nodes = rTargetRoot.Nodes();
+    Kratos::IndexPartition<std::size_t>(r_nodes.size()).for_each([&r_nodes](const std::size_t Index) {
+        (r_nodes.begin() + Index)->SetId(Index + 1);
+    });
+}
+
+
+void PrintUsage()
+{
+    std::cerr << "Usage: linearize_mesh [options] input_path output_path\n"
+              << "Options:\n"
+              << "    --drop-orphan-nodes : do not write nodes that no linear geometry refers to.\n"
+              << "    --renumber-nodes    : assign consecutive node IDs starting at 1.\n";
+}
+
+
 int main(int argc, const char** argv)
 {
-    if (argc != 3) {
+    bool drop_orphan_nodes = false;
+    bool renumber_nodes = false;
+    std::vector<std::filesystem::path> paths;
+
+    for (int i_arg=1; i_arg<argc; ++i_arg) {
+        const std::string argument = argv[i_arg];
+        if (argument == "--drop-orphan-nodes") {
+            drop_orphan_nodes = true;
+        } else if (argument == "--renumber-nodes") {
+            renumber_nodes = true;
+        } else if (argument == "-h" || argument == "--help") {
+            PrintUsage();
+            return 0;
+        } else if (argument.rfind("--", 0) == 0) {
+            std::cerr << "Unknown option: " << argument << "\n";
+            PrintUsage();
+            return 1;
+        } else {
+            paths.emplace_back(argument);
+        }
+    } // for i_arg in range(1, argc)
+
+    if (paths.size() != 2) {
         std::cerr << "linearizemesh expects exactly 2 arguments: input file path and output file path\n";
+        PrintUsage();
         return 1;
     }
-    std::filesystem::path source(argv[1]), target(argv[2]);
+    const std::filesystem::path source = paths[0], target = paths[1];
 
     if (!std::filesystem::exists(source) || std::filesystem::is_directory(source)) {
         std::cerr << "File not found: " << source << "\n";
@@ -129,6 +226,17 @@ int main(int argc, const char** argv)
 
     ProcessModelTree(r_source_model_part, r_target_model_part);
 
+    if (drop_orphan_nodes) {
+        const auto referenced = MarkReferencedNodes(r_source_model_part, r_target_model_part);
+        CopyNodes(r_source_model_part, r_source_model_part, r_target_model_part, &referenced);
+    } else {
+        CopyNodes(r_source_model_part, r_source_model_part, r_target_model_part, nullptr);
+    }
+
+    if (renumber_nodes) {
+        RenumberNodes(r_target_model_part);
+    }
+
     try {
         p_target_io->Write(r_target_model_part);
     } catch (std::exception& rException) {
@@ -0,0 +1,178 @@
+// --- Core Includes ---
+#include "includes/exception.h" // KRATOS_ERROR
+#include "utilities/parallel_utilities.h" // IndexPartition
+
+// --- Internal Includes ---
+#include "KratosExecutables/AffineTransform.hpp"
+
+// --- STL Includes ---
+#include <cmath> // std::sqrt, std::sin, std::cos
+#include <algorithm> // std::min
+
+
+namespace Kratos::Executables {
+
+
+namespace {
+
+
+std::array<double,3> Normalize(const std::array<double,3>& rVector)
+{
+    const double norm = std::sqrt(rVector[0] * rVector[0] + rVector[1] * rVector[1] + rVector[2] * rVector[2]);
+    KRATOS_ERROR_IF_NOT(0.0 < norm) << "cannot normalize a zero vector";
+    return {rVector[0] / norm, rVector[1] / norm, rVector[2] / norm};
+}
+
+
+/// @brief Number of points transformed together in @ref AffineTransform::Apply.
+constexpr std::size_t BlockSize = 512;
+
+
+} // unnamed namespace
+
+
+AffineTransform::AffineTransform() noexcept
+    : mMatrix {1.0, 0.0, 0.0, 0.0,
+               0.0, 1.0, 0.0, 0.0,
+               0.0, 0.0, 1.0, 0.0,
+               0.0, 0.0, 0.0, 1.0}
+{
+}
+
+
+AffineTransform::AffineTransform(const Matrix& rMatrix)
+    : mMatrix(rMatrix)
+{
+    KRATOS_ERROR_IF_NOT(mMatrix[12] == 0.0 && mMatrix[13] == 0.0 && mMatrix[14] == 0.0 && mMatrix[15] == 1.0)
+        << "the last row of an affine transformation matrix must be (0, 0, 0, 1), but got ("
+        << mMatrix[12] << ", " << mMatrix[13] << ", " << mMatrix[14] << ", " << mMatrix[15] << ")";
+}
+
+
+AffineTransform AffineTransform::Scale(double Factor) noexcept
+{
+    return AffineTransform::Scale(Factor, Factor, Factor);
+}
+
+
+AffineTransform AffineTransform::Scale(double FactorX, double FactorY, double FactorZ) noexcept
+{
+    AffineTransform output;
+    output.mMatrix[0] = FactorX;
+    output.mMatrix[5] = FactorY;
+    output.mMatrix[10] = FactorZ;
+    return output;
+}
+
+
+AffineTransform AffineTransform::Translation(double X, double Y, double Z) noexcept
+{
+    AffineTransform output;
+    output.mMatrix[3] = X;
+    output.mMatrix[7] = Y;
+    output.mMatrix[11] = Z;
+    return output;
+}
+
+
+AffineTransform AffineTransform::Rotation(const std::array<double,3>& rAxis, double Angle)
+{
+    // Rodrigues' rotation formula: R = cI + s[n]x + (1-c)nn^T
+    const auto n = Normalize(rAxis);
+    const double c = std::cos(Angle);
+    const double s = std::sin(Angle);
+    const double t = 1.0 - c;
+
+    AffineTransform output;
+    output.mMatrix[0]  = c + t * n[0] * n[0];
+    output.mMatrix[1]  = t * n[0] * n[1] - s * n[2];
+    output.mMatrix[2]  = t * n[0] * n[2] + s * n[1];
+    output.mMatrix[4]  = t * n[1] * n[0] + s * n[2];
+    output.mMatrix[5]  = c + t * n[1] * n[1];
+    output.mMatrix[6]  = t * n[1] * n[2] - s * n[0];
+    output.mMatrix[8]  = t * n[2] * n[0] - s * n[1];
+    output.mMatrix[9]  = t * n[2] * n[1] + s * n[0];
+    output.mMatrix[10] = c + t * n[2] * n[2];
+    return output;
+}
+
+
+AffineTransform AffineTransform::Mirror(const std::array<double,3>& rNormal)
+{
+    // Householder reflection: R = I - 2nn^T
+    const auto n = Normalize(rNormal);
+    AffineTransform output;
+    for (std::size_t i_row = 0; i_row < 3; ++i_row) {
+        for (std::size_t i_column = 0; i_column < 3; ++i_column) {
+            output.mMatrix[4 * i_row + i_column] -= 2.0 * n[i_row] * n[i_column];
+        }
+    }
+    return output;
+}
+
+
+AffineTransform AffineTransform::operator*(const AffineTransform& rRight) const noexcept
+{
+    AffineTransform output;
+    for (std::size_t i_row = 0; i_row < 4; ++i_row) {
+        for (std::size_t i_column = 0; i_column < 4; ++i_column) {
+            double value = 0.0;
+            for (std::size_t i = 0; i < 4; ++i) {
+                value += mMatrix[4 * i_row + i] * rRight.mMatrix[4 * i + i_column];
+            }
+            output.mMatrix[4 * i_row + i_column] = value;
+        }
+    }
+    return output;
+}
+
+
+const AffineTransform::Matrix& AffineTransform::GetMatrix() const noexcept
+{
+    return mMatrix;
+}
+
+
+void AffineTransform::Apply(double* pCoordinates, std::size_t NumberOfPoints) const
+{
+    // Points are processed in blocks that are transposed into local
+    // component arrays, so the arithmetic runs on contiguous data
+    // while the block stays in L1. The loops are marked for vectorization
+    // explicitly, since it is not enabled at every optimization level.
+    const std::size_t number_of_blocks = (NumberOfPoints + BlockSize - 1) / BlockSize;
+    const Matrix m = mMatrix;
+
+    IndexPartition<std::size_t>(number_of_blocks).for_each([pCoordinates, NumberOfPoints, &m](const std::size_t BlockIndex) {
+        alignas(64) double x[BlockSize];
+        alignas(64) double y[BlockSize];
+        alignas(64) double z[BlockSize];
+
+        double* p_begin = pCoordinates + 3 * BlockSize * BlockIndex;
+        const std::size_t size = std::min(BlockSize, NumberOfPoints - BlockSize * BlockIndex);
+
+        #pragma omp simd
+        for (std::size_t i = 0; i < size; ++i) {
+            x[i] = p_begin[3 * i];
+            y[i] = p_begin[3 * i + 1];
+            z[i] = p_begin[3 * i + 2];
+        }
+
+        #pragma omp simd
+        for (std::size_t i = 0; i < size; ++i) {
+            const double x_i = x[i], y_i = y[i], z_i = z[i];
+            x[i] = m[0] * x_i + m[1] * y_i + m[2]  * z_i + m[3];
+            y[i] = m[4] * x_i + m[5] * y_i + m[6]  * z_i + m[7];
+            z[i] = m[8] * x_i + m[9] * y_i + m[10] * z_i + m[11];
+        }
+
+        #pragma omp simd
+        for (std::size_t i = 0; i < size; ++i) {
+            p_begin[3 * i] = x[i];
+            p_begin[3 * i + 1] = y[i];
+            p_begin[3 * i + 2] = z[i];
+        }
+    });
+}
+
+
+} // namespace Kratos::Executables
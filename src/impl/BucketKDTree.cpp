@@ -0,0 +1,308 @@
+// --- Core Includes ---
+#include "includes/exception.h" // KRATOS_ERROR
+
+// --- Internal Includes ---
+#include "KratosExecutables/BucketKDTree.hpp"
+
+// --- STL Includes ---
+#include <array> // std::array
+#include <algorithm> // std::nth_element, std::minmax_element
+#include <numeric> // std::iota
+
+// --- Intrinsics Includes ---
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    #define KRATOS_EXECUTABLES_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+
+namespace Kratos::Executables {
+
+
+namespace {
+
+
+/// @brief Find the points of a leaf within a radius, one at a time.
+/// @details All kernels take the coordinate arrays of a leaf, the indices of its points,
+///          the query, the squared radius and the outputs, and return the number of found
+///          points, stopping at @p Capacity.
+std::size_t FilterLeafScalar(const double* pX, const double* pY, const double* pZ, const std::size_t* pIndices, std::size_t Size,
+                             const double* pPoint, double SquaredRadius,
+                             std::size_t* pResults, double* pSquaredDistances, std::size_t Capacity)
+{
+    std::size_t count = 0;
+    for (std::size_t i_point = 0; i_point < Size && count < Capacity; ++i_point) {
+        const double dx = pX[i_point] - pPoint[0];
+        const double dy = pY[i_point] - pPoint[1];
+        const double dz = pZ[i_point] - pPoint[2];
+        const double squared_distance = dx * dx + dy * dy + dz * dz;
+        if (squared_distance <= SquaredRadius) {
+            pResults[count] = pIndices[i_point];
+            pSquaredDistances[count] = squared_distance;
+            ++count;
+        }
+    }
+    return count;
+}
+
+
+#ifdef KRATOS_EXECUTABLES_X86_KERNELS
+
+
+/// @brief Find the points of a leaf within a radius, four at a time.
+__attribute__((target("avx2")))
+std::size_t FilterLeafAVX2(const double* pX, const double* pY, const double* pZ, const std::size_t* pIndices, std::size_t Size,
+                           const double* pPoint, double SquaredRadius,
+                           std::size_t* pResults, double* pSquaredDistances, std::size_t Capacity)
+{
+    const __m256d x = _mm256_set1_pd(pPoint[0]);
+    const __m256d y = _mm256_set1_pd(pPoint[1]);
+    const __m256d z = _mm256_set1_pd(pPoint[2]);
+    const __m256d squared_radius = _mm256_set1_pd(SquaredRadius);
+
+    std::size_t count = 0;
+    std::size_t i_point = 0;
+    for (; i_point + 4 <= Size; i_point += 4) {
+        const __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(pX + i_point), x);
+        const __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(pY + i_point), y);
+        const __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(pZ + i_point), z);
+        const __m256d squared_distances = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+        int found = _mm256_movemask_pd(_mm256_cmp_pd(squared_distances, squared_radius, _CMP_LE_OQ));
+        if (!found) continue;
+
+        alignas(32) double distances[4];
+        _mm256_store_pd(distances, squared_distances);
+        for (; found; found &= found - 1) {
+            const int i_lane = __builtin_ctz(found);
+            pResults[count] = pIndices[i_point + i_lane];
+            pSquaredDistances[count] = distances[i_lane];
+            if (++count == Capacity) return count;
+        }
+    }
+
+    // Calling the scalar kernel from here would mix VEX and legacy SSE code.
+    for (; i_point < Size; ++i_point) {
+        const double dx = pX[i_point] - pPoint[0];
+        const double dy = pY[i_point] - pPoint[1];
+        const double dz = pZ[i_point] - pPoint[2];
+        const double squared_distance = dx * dx + dy * dy + dz * dz;
+        if (squared_distance <= SquaredRadius) {
+            pResults[count] = pIndices[i_point];
+            pSquaredDistances[count] = squared_distance;
+            if (++count == Capacity) break;
+        }
+    }
+    return count;
+}
+
+
+/// @brief Find the points of a leaf within a radius, eight at a time.
+/// @details The remainder of the leaf is processed with masked loads.
+__attribute__((target("avx512f")))
+std::size_t FilterLeafAVX512(const double* pX, const double* pY, const double* pZ, const std::size_t* pIndices, std::size_t Size,
+                             const double* pPoint, double SquaredRadius,
+                             std::size_t* pResults, double* pSquaredDistances, std::size_t Capacity)
+{
+    static_assert(sizeof(std::size_t) == sizeof(long long), "indices are compressed as 64 bit integers");
+
+    const __m512d x = _mm512_set1_pd(pPoint[0]);
+    const __m512d y = _mm512_set1_pd(pPoint[1]);
+    const __m512d z = _mm512_set1_pd(pPoint[2]);
+    const __m512d squared_radius = _mm512_set1_pd(SquaredRadius);
+
+    std::size_t count = 0;
+    for (std::size_t i_point = 0; i_point < Size; i_point += 8) {
+        const __mmask8 active = Size - i_point < 8 ? static_cast<__mmask8>((1u << (Size - i_point)) - 1) : static_cast<__mmask8>(0xff);
+        const __m512d dx = _mm512_sub_pd(_mm512_maskz_loadu_pd(active, pX + i_point), x);
+        const __m512d dy = _mm512_sub_pd(_mm512_maskz_loadu_pd(active, pY + i_point), y);
+        const __m512d dz = _mm512_sub_pd(_mm512_maskz_loadu_pd(active, pZ + i_point), z);
+        const __m512d squared_distances = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy)), _mm512_mul_pd(dz, dz));
+        __mmask8 found = _mm512_mask_cmp_pd_mask(active, squared_distances, squared_radius, _CMP_LE_OQ);
+        if (!found) continue;
+
+        // Keep the first points that fit in the output.
+        std::size_t number_of_found = __builtin_popcount(found);
+        if (Capacity - count < number_of_found) {
+            __mmask8 kept = 0;
+            for (std::size_t i_kept = 0; i_kept < Capacity - count; ++i_kept) {
+                kept |= found & -found;
+                found &= found - 1;
+            }
+            found = kept;
+            number_of_found = Capacity - count;
+        }
+
+        const __m512i indices = _mm512_maskz_loadu_epi64(active, pIndices + i_point);
+        _mm512_mask_compressstoreu_epi64(pResults + count, found, indices);
+        _mm512_mask_compressstoreu_pd(pSquaredDistances + count, found, squared_distances);
+        count += number_of_found;
+        if (count == Capacity) break;
+    }
+    return count;
+}
+
+
+#endif // KRATOS_EXECUTABLES_X86_KERNELS
+
+
+} // anonymous namespace
+
+
+BucketKDTree::BucketKDTree(std::size_t NumberOfPoints,
+                           const std::function<double(std::size_t,std::size_t)>& rGetCoordinate,
+                           std::size_t LeafSize,
+                           Kernel LeafKernel)
+    : mKernel(LeafKernel),
+      mpKernel(&FilterLeafScalar)
+{
+    KRATOS_ERROR_IF_NOT(BucketKDTree::IsSupported(LeafKernel)) << "unsupported leaf kernel " << static_cast<int>(LeafKernel);
+    #ifdef KRATOS_EXECUTABLES_X86_KERNELS
+    if (LeafKernel == Kernel::AVX2) mpKernel = &FilterLeafAVX2;
+    if (LeafKernel == Kernel::AVX512) mpKernel = &FilterLeafAVX512;
+    #endif
+
+    const std::size_t leaf_size = std::max<std::size_t>(LeafSize, 1);
+    std::vector<std::array<double,3>> points(NumberOfPoints);
+    for (std::size_t i_point = 0; i_point < NumberOfPoints; ++i_point) {
+        for (std::size_t i_dimension = 0; i_dimension < 3; ++i_dimension) {
+            points[i_point][i_dimension] = rGetCoordinate(i_point, i_dimension);
+        }
+    }
+
+    mIndices.resize(NumberOfPoints);
+    std::iota(mIndices.begin(), mIndices.end(), 0);
+
+    // Split nodes depth first, reordering the indices of their points in place.
+    struct Range
+    {
+        std::size_t mNode;
+
+        std::size_t mBegin;
+
+        std::size_t mEnd;
+    }; // struct Range
+
+    mNodes.push_back(Node {3, 0.0, 0, NumberOfPoints});
+    std::vector<Range> ranges {Range {0, 0, NumberOfPoints}};
+    while (!ranges.empty()) {
+        const Range range = ranges.back();
+        ranges.pop_back();
+        const auto it_begin = mIndices.begin() + range.mBegin;
+        const auto it_end = mIndices.begin() + range.mEnd;
+        if (range.mEnd - range.mBegin <= leaf_size) {
+            mNodes[range.mNode] = Node {3, 0.0, range.mBegin, range.mEnd};
+            continue;
+        }
+
+        std::size_t dimension = 0;
+        double widest = -1.0;
+        for (std::size_t i_dimension = 0; i_dimension < 3; ++i_dimension) {
+            const auto [it_min, it_max] = std::minmax_element(it_begin, it_end, [&points, i_dimension](std::size_t Left, std::size_t Right) {
+                return points[Left][i_dimension] < points[Right][i_dimension];
+            });
+            const double extent = points[*it_max][i_dimension] - points[*it_min][i_dimension];
+            if (widest < extent) {
+                widest = extent;
+                dimension = i_dimension;
+            }
+        }
+
+        const std::size_t middle = range.mBegin + (range.mEnd - range.mBegin) / 2;
+        std::nth_element(it_begin, mIndices.begin() + middle, it_end, [&points, dimension](std::size_t Left, std::size_t Right) {
+            return points[Left][dimension] < points[Right][dimension];
+        });
+
+        const std::size_t i_left = mNodes.size();
+        const std::size_t i_right = i_left + 1;
+        mNodes[range.mNode] = Node {dimension, points[mIndices[middle]][dimension], i_left, i_right};
+        mNodes.push_back(Node {3, 0.0, range.mBegin, middle});
+        mNodes.push_back(Node {3, 0.0, middle, range.mEnd});
+        ranges.push_back(Range {i_right, middle, range.mEnd});
+        ranges.push_back(Range {i_left, range.mBegin, middle});
+    }
+
+    mX.resize(NumberOfPoints);
+    mY.resize(NumberOfPoints);
+    mZ.resize(NumberOfPoints);
+    for (std::size_t i_point = 0; i_point < NumberOfPoints; ++i_point) {
+        const auto& r_point = points[mIndices[i_point]];
+        mX[i_point] = r_point[0];
+        mY[i_point] = r_point[1];
+        mZ[i_point] = r_point[2];
+    }
+}
+
+
+std::size_t BucketKDTree::SearchInRadius(const double* pPoint,
+                                         double Radius,
+                                         std::size_t* pResults,
+                                         double* pSquaredDistances,
+                                         std::size_t MaxNumberOfResults) const
+{
+    const double squared_radius = Radius * Radius;
+    std::size_t count = 0;
+
+    // The depth of the tree is logarithmic in the number of points.
+    std::array<std::size_t,128> stack;
+    std::size_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size && count < MaxNumberOfResults) {
+        const Node& r_node = mNodes[stack[--stack_size]];
+        if (r_node.mDimension == 3) {
+            count += mpKernel(mX.data() + r_node.mFirst, mY.data() + r_node.mFirst, mZ.data() + r_node.mFirst,
+                              mIndices.data() + r_node.mFirst, r_node.mSecond - r_node.mFirst,
+                              pPoint, squared_radius,
+                              pResults + count, pSquaredDistances + count, MaxNumberOfResults - count);
+            continue;
+        }
+
+        // Points equal to the split value may be on either side.
+        const double offset = pPoint[r_node.mDimension] - r_node.mValue;
+        if (-Radius <= offset) stack[stack_size++] = r_node.mSecond;
+        if (offset <= Radius) stack[stack_size++] = r_node.mFirst;
+    }
+
+    return count;
+}
+
+
+std::size_t BucketKDTree::NumberOfPoints() const noexcept
+{
+    return mIndices.size();
+}
+
+
+BucketKDTree::Kernel BucketKDTree::GetKernel() const noexcept
+{
+    return mKernel;
+}
+
+
+bool BucketKDTree::IsSupported(Kernel LeafKernel) noexcept
+{
+    switch (LeafKernel) {
+        case Kernel::Scalar:
+            return true;
+        #ifdef KRATOS_EXECUTABLES_X86_KERNELS
+        case Kernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case Kernel::AVX512:
+            return __builtin_cpu_supports("avx512f");
+        #endif
+        default:
+            return false;
+    }
+}
+
+
+BucketKDTree::Kernel BucketKDTree::GetBestKernel() noexcept
+{
+    for (Kernel kernel : {Kernel::AVX512, Kernel::AVX2}) {
+        if (BucketKDTree::IsSupported(kernel)) return kernel;
+    }
+    return Kernel::Scalar;
+}
+
+
+} // namespace Kratos::Executables
@@ -15,6 +15,7 @@
 #ifdef KRATOSEXECUTABLES_HDF5_APPLICATION
 #include "custom_io/hdf5_model_part_io.h"
 #include "custom_io/hdf5_file.h"
+#include "custom_io/hdf5_nodal_solution_step_data_io.h"
 #endif
 
 // --- STL Includes ---
@@ -136,6 +137,19 @@ void HDF5ModelPartIO::Read(ModelPart& rTarget) const
         rTarget.GetCommunicator().GetDataCommunicator(),
         file_parameters));
     Kratos::HDF5::ModelPartIO(p_file, "/ModelData").ReadModelPart(rTarget);
+
+    // Read results of the variables the target was prepared for, if the file has any.
+    const auto& r_variables = rTarget.GetNodalSolutionStepVariablesList();
+    if (r_variables.size() && p_file->HasPath("/ResultsData/NodalSolutionStepData")) {
+        Kratos::Parameters io_parameters(R"({
+            "prefix" : "/ResultsData",
+            "list_of_variables" : []
+        })");
+        for (const auto& r_variable : r_variables) {
+            io_parameters["list_of_variables"].Append(r_variable.Name());
+        }
+        Kratos::HDF5::NodalSolutionStepDataIO(io_parameters, p_file).ReadNodalResults(rTarget.Nodes(), rTarget.GetCommunicator(), 0);
+    }
     #else
     KRATOS_ERROR << "KratosExecutables was built without HDF5 support."
     #endif
@@ -0,0 +1,187 @@
+// --- Internal Includes ---
+#include "KratosExecutables/PerformanceCounters.hpp"
+
+// --- STL Includes ---
+#include <array> // std::array
+#include <cstdint> // std::uint64_t
+#include <cstring> // std::strerror
+#include <cerrno> // errno
+#include <filesystem> // std::filesystem::directory_iterator
+
+// --- POSIX Includes ---
+#ifdef __linux__
+    #include <linux/perf_event.h> // perf_event_attr, PERF_*
+    #include <sys/syscall.h> // SYS_perf_event_open
+    #include <unistd.h> // syscall, read, close
+#endif
+
+
+namespace Kratos::Executables {
+
+
+namespace {
+
+
+struct EventDefinition
+{
+    const char* mName;
+
+    std::uint32_t mType;
+
+    std::uint64_t mConfig;
+}; // struct EventDefinition
+
+
+/// Value, time enabled and time running of an event (see PERF_FORMAT_TOTAL_TIME_*).
+using EventSample = std::array<std::uint64_t,3>;
+
+
+} // anonymous namespace
+
+
+struct PerformanceCounters::Impl
+{
+    struct Event
+    {
+        std::string mName;
+
+        /// One per thread that existed when the event was opened.
+        std::vector<int> mFileDescriptors;
+
+        EventSample mStart {0, 0, 0};
+    }; // struct Event
+
+    EventSample Sample(const Event& rEvent) const
+    {
+        EventSample output {0, 0, 0};
+        #ifdef __linux__
+        for (int file_descriptor : rEvent.mFileDescriptors) {
+            EventSample sample {0, 0, 0};
+            if (read(file_descriptor, sample.data(), sizeof(sample)) == static_cast<ssize_t>(sizeof(sample))) {
+                for (std::size_t i_component = 0; i_component < output.size(); ++i_component) {
+                    output[i_component] += sample[i_component];
+                }
+            }
+        }
+        #endif
+        return output;
+    }
+
+    std::vector<Event> mEvents;
+
+    std::vector<std::pair<std::string,std::string>> mUnavailableEvents;
+}; // struct PerformanceCounters::Impl
+
+
+PerformanceCounters::PerformanceCounters()
+    : mpImpl(new Impl)
+{
+    #ifdef __linux__
+    constexpr std::uint64_t read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    const std::array<EventDefinition,5> definitions {{
+        {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {"l1d_misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | read_miss},
+        {"llc_misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | read_miss}
+    }};
+
+    std::vector<pid_t> threads;
+    std::error_code error;
+    for (const auto& r_entry : std::filesystem::directory_iterator("/proc/self/task", error)) {
+        threads.push_back(std::stoi(r_entry.path().filename().string()));
+    }
+    if (threads.empty()) threads.push_back(0);
+
+    for (const auto& r_definition : definitions) {
+        perf_event_attr attributes {};
+        attributes.size = sizeof(attributes);
+        attributes.type = r_definition.mType;
+        attributes.config = r_definition.mConfig;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attributes.inherit = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        Impl::Event event {r_definition.mName, {}, {0, 0, 0}};
+        // Threads that exited since they were listed are skipped.
+        std::string failure;
+        for (pid_t thread : threads) {
+            const int file_descriptor = static_cast<int>(syscall(SYS_perf_event_open, &attributes, thread, -1, -1, PERF_FLAG_FD_CLOEXEC));
+            if (0 <= file_descriptor) {
+                event.mFileDescriptors.push_back(file_descriptor);
+            } else if (errno != ESRCH) {
+                failure = std::strerror(errno);
+                break;
+            }
+        }
+
+        if (failure.empty() && !event.mFileDescriptors.empty()) {
+            mpImpl->mEvents.push_back(std::move(event));
+        } else {
+            for (int file_descriptor : event.mFileDescriptors) close(file_descriptor);
+            mpImpl->mUnavailableEvents.emplace_back(r_definition.mName, failure.empty() ? "no threads" : failure);
+        }
+    }
+    #else
+    for (const char* p_name : {"cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses"}) {
+        mpImpl->mUnavailableEvents.emplace_back(p_name, "perf_event_open is only available on Linux");
+    }
+    #endif
+}
+
+
+PerformanceCounters::PerformanceCounters(PerformanceCounters&&) noexcept = default;
+
+
+PerformanceCounters::~PerformanceCounters()
+{
+    #ifdef __linux__
+    if (mpImpl) {
+        for (const auto& r_event : mpImpl->mEvents) {
+            for (int file_descriptor : r_event.mFileDescriptors) close(file_descriptor);
+        }
+    }
+    #endif
+}
+
+
+bool PerformanceCounters::IsAvailable() const noexcept
+{
+    return !mpImpl->mEvents.empty();
+}
+
+
+const std::vector<std::pair<std::string,std::string>>& PerformanceCounters::GetUnavailableEvents() const noexcept
+{
+    return mpImpl->mUnavailableEvents;
+}
+
+
+void PerformanceCounters::Start()
+{
+    // Counters run continuously, and measurements are differences between samples.
+    for (auto& r_event : mpImpl->mEvents) {
+        r_event.mStart = mpImpl->Sample(r_event);
+    }
+}
+
+
+std::vector<std::pair<std::string,double>> PerformanceCounters::Read() const
+{
+    std::vector<std::pair<std::string,double>> output;
+    for (const auto& r_event : mpImpl->mEvents) {
+        const EventSample sample = mpImpl->Sample(r_event);
+        const std::uint64_t value = sample[0] - r_event.mStart[0];
+        const std::uint64_t enabled = sample[1] - r_event.mStart[1];
+        const std::uint64_t running = sample[2] - r_event.mStart[2];
+
+        // Events that never got a hardware counter have no estimate.
+        if (!running) continue;
+        output.emplace_back(r_event.mName, static_cast<double>(value) * enabled / running);
+    }
+    return output;
+}
+
+
+} // namespace Kratos::Executables
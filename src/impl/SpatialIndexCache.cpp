@@ -0,0 +1,242 @@
+// --- Core Includes ---
+#include "includes/exception.h" // KRATOS_ERROR
+
+// --- Internal Includes ---
+#include "KratosExecutables/SpatialIndexCache.hpp"
+
+// --- STL Includes ---
+#include <fstream> // std::ofstream
+#include <sstream> // std::stringstream
+#include <iomanip> // std::hex, std::setw, std::setfill
+#include <cstring> // std::memcpy, std::strerror
+#include <cerrno> // errno
+#include <array> // std::array
+
+// --- POSIX Includes ---
+#include <fcntl.h> // open
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close
+
+
+namespace Kratos::Executables {
+
+
+namespace {
+
+
+/// @brief Header preceding each serialized index.
+struct CacheHeader
+{
+    std::array<char,8> mMagic;
+
+    std::uint64_t mVersion;
+
+    std::uint64_t mKey;
+
+    /// Number of bytes following the header.
+    std::uint64_t mSize;
+}; // struct CacheHeader
+
+
+constexpr std::array<char,8> CacheMagic {'K', 'E', 'X', 'I', 'N', 'D', 'E', 'X'};
+
+
+constexpr std::uint64_t CacheVersion = 1;
+
+
+} // anonymous namespace
+
+
+void CoordinateHash::Add(double Value) noexcept
+{
+    // Identify +0 and -0, which compare equal.
+    if (Value == 0.0) Value = 0.0;
+    std::uint64_t bits;
+    std::memcpy(&bits, &Value, sizeof(bits));
+    this->Add(bits);
+}
+
+
+void CoordinateHash::Add(std::uint64_t Value) noexcept
+{
+    // FNV-1a over 64 bit words, followed by a multiplicative mix.
+    mHash = (mHash ^ Value) * 0x100000001b3ull;
+    mHash ^= mHash >> 29;
+}
+
+
+std::uint64_t CoordinateHash::Get() const noexcept
+{
+    return mHash;
+}
+
+
+struct MappedFile::Impl
+{
+    const char* mpData = nullptr;
+
+    std::size_t mSize = 0;
+}; // struct MappedFile::Impl
+
+
+MappedFile::MappedFile(const std::filesystem::path& rFilePath)
+    : mpImpl(new Impl)
+{
+    const int file_descriptor = open(rFilePath.c_str(), O_RDONLY);
+    KRATOS_ERROR_IF(file_descriptor < 0) << "cannot open " << rFilePath << ": " << std::strerror(errno);
+
+    struct stat status;
+    if (fstat(file_descriptor, &status) != 0) {
+        const int error = errno;
+        close(file_descriptor);
+        KRATOS_ERROR << "cannot stat " << rFilePath << ": " << std::strerror(error);
+    }
+
+    mpImpl->mSize = status.st_size;
+    if (mpImpl->mSize) {
+        void* p_data = mmap(nullptr, mpImpl->mSize, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+        const int error = errno;
+        close(file_descriptor);
+        KRATOS_ERROR_IF(p_data == MAP_FAILED) << "cannot map " << rFilePath << ": " << std::strerror(error);
+
+        // Indices are read front to back.
+        madvise(p_data, mpImpl->mSize, MADV_SEQUENTIAL);
+        mpImpl->mpData = static_cast<const char*>(p_data);
+    } else {
+        close(file_descriptor);
+    }
+}
+
+
+MappedFile::MappedFile(MappedFile&&) noexcept = default;
+
+
+MappedFile::~MappedFile()
+{
+    if (mpImpl && mpImpl->mpData) {
+        munmap(const_cast<char*>(mpImpl->mpData), mpImpl->mSize);
+    }
+}
+
+
+const char* MappedFile::Data() const noexcept
+{
+    return mpImpl->mpData;
+}
+
+
+std::size_t MappedFile::Size() const noexcept
+{
+    return mpImpl->mSize;
+}
+
+
+MemoryStreamBuffer::MemoryStreamBuffer(const char* pBegin, std::size_t Size)
+{
+    // The get area is never written through, despite std::streambuf's non-const pointers.
+    char* p_begin = const_cast<char*>(pBegin);
+    this->setg(p_begin, p_begin, p_begin + Size);
+}
+
+
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekoff(off_type Offset,
+                                                         std::ios_base::seekdir Direction,
+                                                         std::ios_base::openmode Mode)
+{
+    if (!(Mode & std::ios_base::in)) {
+        return pos_type(off_type(-1));
+    }
+
+    char* p_position = nullptr;
+    if (Direction == std::ios_base::beg) {
+        p_position = this->eback() + Offset;
+    } else if (Direction == std::ios_base::cur) {
+        p_position = this->gptr() + Offset;
+    } else {
+        p_position = this->egptr() + Offset;
+    }
+
+    if (p_position < this->eback() || this->egptr() < p_position) {
+        return pos_type(off_type(-1));
+    }
+    this->setg(this->eback(), p_position, this->egptr());
+    return pos_type(p_position - this->eback());
+}
+
+
+MemoryStreamBuffer::pos_type MemoryStreamBuffer::seekpos(pos_type Position, std::ios_base::openmode Mode)
+{
+    return this->seekoff(off_type(Position), std::ios_base::beg, Mode);
+}
+
+
+SpatialIndexCache::SpatialIndexCache(const std::filesystem::path& rDirectory, const std::string& rPrefix)
+    : mDirectory(rDirectory),
+      mPrefix(rPrefix)
+{
+}
+
+
+std::filesystem::path SpatialIndexCache::GetPath(std::uint64_t Key) const
+{
+    std::stringstream name;
+    name << mPrefix << "." << std::hex << std::setw(16) << std::setfill('0') << Key << ".index";
+    return mDirectory / name.str();
+}
+
+
+bool SpatialIndexCache::Load(std::uint64_t Key, const std::function<void(std::istream&)>& rLoad) const
+{
+    const std::filesystem::path path = this->GetPath(Key);
+    if (!std::filesystem::is_regular_file(path)) {
+        return false;
+    }
+
+    const MappedFile file(path);
+    CacheHeader header;
+    if (file.Size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (header.mMagic != CacheMagic || header.mVersion != CacheVersion || header.mKey != Key || header.mSize != file.Size() - sizeof(header)) {
+        return false;
+    }
+
+    MemoryStreamBuffer buffer(file.Data() + sizeof(header), file.Size() - sizeof(header));
+    std::istream stream(&buffer);
+    rLoad(stream);
+    KRATOS_ERROR_IF(stream.fail()) << "corrupt spatial index cache file " << path;
+    return true;
+}
+
+
+void SpatialIndexCache::Store(std::uint64_t Key, const std::function<void(std::ostream&)>& rSave) const
+{
+    const std::filesystem::path path = this->GetPath(Key);
+    std::filesystem::path temporary_path = path;
+    temporary_path += "." + std::to_string(getpid()) + ".tmp";
+
+    {
+        std::ofstream file(temporary_path, std::ios::binary);
+        KRATOS_ERROR_IF_NOT(file) << "cannot open " << temporary_path << " for writing";
+
+        // The size is only known after serializing the index.
+        CacheHeader header {CacheMagic, CacheVersion, Key, 0};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        rSave(file);
+        header.mSize = static_cast<std::uint64_t>(file.tellp()) - sizeof(header);
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.close();
+        if (!file) {
+            std::filesystem::remove(temporary_path);
+            KRATOS_ERROR << "failed to write " << temporary_path;
+        }
+    }
+
+    std::filesystem::rename(temporary_path, path);
+}
+
+
+} // namespace Kratos::Executables
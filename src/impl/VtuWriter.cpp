@@ -0,0 +1,544 @@
+// --- Core Includes ---
+#include "includes/exception.h" // KRATOS_ERROR
+#include "utilities/parallel_utilities.h" // IndexPartition
+
+// --- Internal Includes ---
+#include "KratosExecutables/VtuWriter.hpp"
+
+// --- Optional Compression Includes ---
+#ifdef KRATOSEXECUTABLES_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef KRATOSEXECUTABLES_LZ4
+#include <lz4.h>
+#endif
+
+// --- STL Includes ---
+#include <fstream> // std::ofstream
+#include <ostream> // std::ostream
+#include <type_traits> // std::is_same_v, std::decay_t
+#include <limits> // std::numeric_limits
+#include <algorithm> // std::min
+
+
+namespace Kratos::Executables {
+
+
+namespace {
+
+
+struct NamedArray
+{
+    std::string mName;
+    VtuWriter::DataArray mArray;
+    std::size_t mNumberOfComponents;
+}; // struct NamedArray
+
+
+template <class TValue>
+constexpr const char* GetVtkTypeName() noexcept
+{
+    if constexpr (std::is_same_v<TValue,std::uint8_t>) return "UInt8";
+    else if constexpr (std::is_same_v<TValue,std::int32_t>) return "Int32";
+    else if constexpr (std::is_same_v<TValue,std::int64_t>) return "Int64";
+    else if constexpr (std::is_same_v<TValue,double>) return "Float64";
+}
+
+
+std::size_t GetSize(const VtuWriter::DataArray& rArray) noexcept
+{
+    return std::visit([](const auto& r_array){return r_array.size();}, rArray);
+}
+
+
+/// @brief Get a view of an array's values as raw bytes.
+std::pair<const char*,std::size_t> GetBytes(const VtuWriter::DataArray& rArray) noexcept
+{
+    return std::visit([](const auto& r_array){
+        using Value = typename std::decay_t<decltype(r_array)>::value_type;
+        return std::make_pair(reinterpret_cast<const char*>(r_array.data()), r_array.size() * sizeof(Value));
+    }, rArray);
+}
+
+
+template <class TValue>
+void AppendValue(std::vector<char>& rBuffer, TValue Value)
+{
+    const char* p_begin = reinterpret_cast<const char*>(&Value);
+    rBuffer.insert(rBuffer.end(), p_begin, p_begin + sizeof(TValue));
+}
+
+
+class Base64Encoder
+{
+public:
+    explicit Base64Encoder(std::ostream& rStream) noexcept
+        : mrStream(rStream),
+          mBuffer {0, 0, 0},
+          mBufferSize(0)
+    {
+    }
+
+    ~Base64Encoder()
+    {
+        this->Flush();
+    }
+
+    void Write(const char* pBegin, std::size_t Size)
+    {
+        for (const char* p_end=pBegin+Size; pBegin!=p_end; ++pBegin) {
+            mBuffer[mBufferSize++] = static_cast<unsigned char>(*pBegin);
+            if (mBufferSize == 3) {
+                this->EncodeBuffer();
+            }
+        }
+    }
+
+    /// @brief Encode remaining bytes with padding.
+    void Flush()
+    {
+        if (mBufferSize) {
+            const std::size_t size = mBufferSize;
+            for (std::size_t i=size; i<3; ++i) mBuffer[i] = 0;
+            char output[4];
+            this->Encode(output);
+            for (std::size_t i=size+1; i<4; ++i) output[i] = '=';
+            mrStream.write(output, 4);
+            mBufferSize = 0;
+        }
+    }
+
+private:
+    void Encode(char* pOutput) const noexcept
+    {
+        constexpr const char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        pOutput[0] = table[mBuffer[0] >> 2];
+        pOutput[1] = table[((mBuffer[0] & 0x03) << 4) | (mBuffer[1] >> 4)];
+        pOutput[2] = table[((mBuffer[1] & 0x0f) << 2) | (mBuffer[2] >> 6)];
+        pOutput[3] = table[mBuffer[2] & 0x3f];
+    }
+
+    void EncodeBuffer()
+    {
+        char output[4];
+        this->Encode(output);
+        mrStream.write(output, 4);
+        mBufferSize = 0;
+    }
+
+    std::ostream& mrStream;
+
+    unsigned char mBuffer[3];
+
+    std::size_t mBufferSize;
+}; // class Base64Encoder
+
+
+/// @brief Compress a contiguous block of bytes with the codec matching the output format.
+std::vector<char> CompressBlock([[maybe_unused]] const char* pBegin,
+                                [[maybe_unused]] std::size_t Size,
+                                VtuWriter::Format OutputFormat)
+{
+    std::vector<char> output;
+
+    if (OutputFormat == VtuWriter::Format::ZLibAppended) {
+        #ifdef KRATOSEXECUTABLES_ZLIB
+        uLongf compressed_size = compressBound(Size);
+        output.resize(compressed_size);
+        // Favor throughput: the arrays are mostly smooth integer sequences and
+        // coordinates, for which higher levels barely improve the ratio.
+        const int status = compress2(reinterpret_cast<Bytef*>(output.data()),
+                                     &compressed_size,
+                                     reinterpret_cast<const Bytef*>(pBegin),
+                                     Size,
+                                     Z_BEST_SPEED);
+        KRATOS_ERROR_IF_NOT(status == Z_OK) << "zlib compression failed with status " << status;
+        output.resize(compressed_size);
+        #else
+        KRATOS_ERROR << "KratosExecutables was built without zlib support.";
+        #endif
+    } else if (OutputFormat == VtuWriter::Format::LZ4Appended) {
+        #ifdef KRATOSEXECUTABLES_LZ4
+        output.resize(LZ4_compressBound(static_cast<int>(Size)));
+        const int compressed_size = LZ4_compress_default(pBegin,
+                                                         output.data(),
+                                                         static_cast<int>(Size),
+                                                         static_cast<int>(output.size()));
+        KRATOS_ERROR_IF_NOT(0 < compressed_size) << "lz4 compression failed";
+        output.resize(compressed_size);
+        #else
+        KRATOS_ERROR << "KratosExecutables was built without lz4 support.";
+        #endif
+    } else {
+        KRATOS_ERROR << "Format " << static_cast<int>(OutputFormat) << " is not compressed";
+    }
+
+    return output;
+}
+
+
+} // anonymous namespace
+
+
+struct VtuWriter::Impl
+{
+    /// @brief Uncompressed size of the blocks compressed arrays are split into.
+    static constexpr std::size_t CompressionBlockSize = 1 << 20;
+
+    bool IsAppended() const noexcept
+    {
+        return mFormat == Format::RawAppended
+            || mFormat == Format::ZLibAppended
+            || mFormat == Format::LZ4Appended;
+    }
+
+    bool IsCompressed() const noexcept
+    {
+        return mFormat == Format::ZLibAppended
+            || mFormat == Format::LZ4Appended;
+    }
+
+    /// @brief Collect all arrays in the order they appear in the output.
+    std::vector<const NamedArray*> GetArrays() const
+    {
+        std::vector<const NamedArray*> output;
+        for (const auto& r_array : mFieldData) output.push_back(&r_array);
+        output.push_back(&mPoints);
+        output.push_back(&mConnectivity);
+        output.push_back(&mOffsets);
+        output.push_back(&mTypes);
+        for (const auto& r_array : mPointData) output.push_back(&r_array);
+        for (const auto& r_array : mCellData) output.push_back(&r_array);
+        return output;
+    }
+
+    /// @brief Compress arrays into their appended representation.
+    /// @details Arrays are split into blocks that get compressed in parallel, and prefixed
+    ///          by a header of the block count, block size, last block size and the
+    ///          compressed size of each block.
+    std::vector<std::vector<char>> Compress(const std::vector<const NamedArray*>& rArrays) const
+    {
+        std::vector<std::vector<char>> output(rArrays.size());
+
+        // Flatten (array, block) pairs to balance the load of large and small arrays.
+        std::vector<std::pair<std::size_t,std::size_t>> blocks;
+        std::vector<std::size_t> block_begins;
+        for (std::size_t i_array=0; i_array<rArrays.size(); ++i_array) {
+            block_begins.push_back(blocks.size());
+            const std::size_t size = GetBytes(rArrays[i_array]->mArray).second;
+            const std::size_t number_of_blocks = (size + CompressionBlockSize - 1) / CompressionBlockSize;
+            for (std::size_t i_block=0; i_block<number_of_blocks; ++i_block) {
+                blocks.emplace_back(i_array, i_block);
+            }
+        }
+        block_begins.push_back(blocks.size());
+
+        std::vector<std::vector<char>> compressed_blocks(blocks.size());
+        const Format format = mFormat;
+        IndexPartition<std::size_t>(blocks.size()).for_each([&](std::size_t i_block){
+            const auto [p_begin, size] = GetBytes(rArrays[blocks[i_block].first]->mArray);
+            const std::size_t begin = blocks[i_block].second * CompressionBlockSize;
+            compressed_blocks[i_block] = CompressBlock(p_begin + begin,
+                                                       std::min(CompressionBlockSize, size - begin),
+                                                       format);
+        });
+
+        for (std::size_t i_array=0; i_array<rArrays.size(); ++i_array) {
+            const std::size_t size = GetBytes(rArrays[i_array]->mArray).second;
+            const std::size_t number_of_blocks = block_begins[i_array + 1] - block_begins[i_array];
+            auto& r_output = output[i_array];
+
+            AppendValue<std::uint64_t>(r_output, number_of_blocks);
+            AppendValue<std::uint64_t>(r_output, CompressionBlockSize);
+            AppendValue<std::uint64_t>(r_output, size % CompressionBlockSize);
+            for (std::size_t i_block=block_begins[i_array]; i_block<block_begins[i_array + 1]; ++i_block) {
+                AppendValue<std::uint64_t>(r_output, compressed_blocks[i_block].size());
+            }
+            for (std::size_t i_block=block_begins[i_array]; i_block<block_begins[i_array + 1]; ++i_block) {
+                r_output.insert(r_output.end(), compressed_blocks[i_block].begin(), compressed_blocks[i_block].end());
+                std::vector<char>().swap(compressed_blocks[i_block]);
+            }
+        }
+
+        return output;
+    }
+
+    /// @param pOffset Offset of the array in the appended data section, incremented by @p AppendedSize.
+    void WriteArray(std::ostream& rStream,
+                    const NamedArray& rArray,
+                    bool IsFieldData,
+                    std::size_t* pOffset,
+                    std::size_t AppendedSize) const
+    {
+        std::visit([&rStream, &rArray, IsFieldData, pOffset, AppendedSize, this](const auto& r_array){
+            using Value = typename std::decay_t<decltype(r_array)>::value_type;
+            rStream << "<DataArray type=\"" << GetVtkTypeName<Value>() << "\" Name=\"" << rArray.mName << "\"";
+            if (IsFieldData) {
+                rStream << " NumberOfTuples=\"" << r_array.size() << "\"";
+            } else {
+                rStream << " NumberOfComponents=\"" << rArray.mNumberOfComponents << "\"";
+            }
+
+            if (this->IsAppended()) {
+                rStream << " format=\"appended\" offset=\"" << *pOffset << "\"/>\n";
+                *pOffset += AppendedSize;
+                return;
+            } else if (mFormat == Format::ASCII) {
+                rStream << " format=\"ascii\">\n";
+                rStream.precision(std::numeric_limits<double>::max_digits10);
+                for (const auto value : r_array) {
+                    if constexpr (std::is_same_v<Value,std::uint8_t>) {
+                        rStream << static_cast<int>(value) << ' ';
+                    } else {
+                        rStream << value << ' ';
+                    }
+                }
+            } else {
+                rStream << " format=\"binary\">\n";
+                const std::uint64_t number_of_bytes = r_array.size() * sizeof(Value);
+                Base64Encoder encoder(rStream);
+                encoder.Write(reinterpret_cast<const char*>(&number_of_bytes), sizeof(number_of_bytes));
+                encoder.Write(reinterpret_cast<const char*>(r_array.data()), number_of_bytes);
+            }
+            rStream << "\n</DataArray>\n";
+        }, rArray.mArray);
+    }
+
+    Format mFormat;
+
+    NamedArray mPoints;
+
+    NamedArray mConnectivity;
+
+    NamedArray mOffsets;
+
+    NamedArray mTypes;
+
+    std::vector<NamedArray> mPointData;
+
+    std::vector<NamedArray> mCellData;
+
+    std::vector<NamedArray> mFieldData;
+}; // struct VtuWriter::Impl
+
+
+VtuWriter::VtuWriter(Format OutputFormat)
+    : mpImpl(new Impl {OutputFormat,
+                       NamedArray {"Points", std::vector<double>(), 3},
+                       NamedArray {"connectivity", std::vector<std::int64_t>(), 1},
+                       NamedArray {"offsets", std::vector<std::int64_t>(), 1},
+                       NamedArray {"types", std::vector<std::uint8_t>(), 1},
+                       {},
+                       {},
+                       {}})
+{
+    #ifndef KRATOSEXECUTABLES_ZLIB
+    KRATOS_ERROR_IF(OutputFormat == Format::ZLibAppended) << "KratosExecutables was built without zlib support.";
+    #endif
+    #ifndef KRATOSEXECUTABLES_LZ4
+    KRATOS_ERROR_IF(OutputFormat == Format::LZ4Appended) << "KratosExecutables was built without lz4 support.";
+    #endif
+}
+
+
+VtuWriter::VtuWriter(VtuWriter&& rOther) noexcept = default;
+
+
+VtuWriter& VtuWriter::operator=(VtuWriter&& rOther) noexcept = default;
+
+
+VtuWriter::~VtuWriter() = default;
+
+
+void VtuWriter::SetPoints(std::vector<double>&& rCoordinates)
+{
+    KRATOS_ERROR_IF(rCoordinates.size() % 3) << "Point coordinates must be provided as xyz triplets";
+    mpImpl->mPoints.mArray = std::move(rCoordinates);
+}
+
+
+void VtuWriter::SetCells(std::vector<std::int64_t>&& rConnectivity,
+                         std::vector<std::int64_t>&& rOffsets,
+                         std::vector<std::uint8_t>&& rTypes)
+{
+    KRATOS_ERROR_IF_NOT(rOffsets.size() == rTypes.size())
+        << "Number of cell offsets (" << rOffsets.size() << ") "
+        << "does not match the number of cell types (" << rTypes.size() << ")";
+    KRATOS_ERROR_IF_NOT(rOffsets.empty() || static_cast<std::size_t>(rOffsets.back()) == rConnectivity.size())
+        << "Last cell offset (" << rOffsets.back() << ") "
+        << "does not match the size of the connectivity array (" << rConnectivity.size() << ")";
+    mpImpl->mConnectivity.mArray = std::move(rConnectivity);
+    mpImpl->mOffsets.mArray = std::move(rOffsets);
+    mpImpl->mTypes.mArray = std::move(rTypes);
+}
+
+
+void VtuWriter::AddPointData(const std::string& rName,
+                             DataArray&& rArray,
+                             std::size_t NumberOfComponents)
+{
+    KRATOS_ERROR_IF_NOT(GetSize(rArray) == this->NumberOfPoints() * NumberOfComponents)
+        << "Point data array \"" << rName << "\" has " << GetSize(rArray) << " values "
+        << "but expecting " << this->NumberOfPoints() * NumberOfComponents;
+    mpImpl->mPointData.push_back(NamedArray {rName, std::move(rArray), NumberOfComponents});
+}
+
+
+void VtuWriter::AddCellData(const std::string& rName,
+                            DataArray&& rArray,
+                            std::size_t NumberOfComponents)
+{
+    KRATOS_ERROR_IF_NOT(GetSize(rArray) == this->NumberOfCells() * NumberOfComponents)
+        << "Cell data array \"" << rName << "\" has " << GetSize(rArray) << " values "
+        << "but expecting " << this->NumberOfCells() * NumberOfComponents;
+    mpImpl->mCellData.push_back(NamedArray {rName, std::move(rArray), NumberOfComponents});
+}
+
+
+void VtuWriter::AddFieldData(const std::string& rName,
+                             DataArray&& rArray)
+{
+    mpImpl->mFieldData.push_back(NamedArray {rName, std::move(rArray), 1});
+}
+
+
+std::size_t VtuWriter::NumberOfPoints() const noexcept
+{
+    return GetSize(mpImpl->mPoints.mArray) / 3;
+}
+
+
+std::size_t VtuWriter::NumberOfCells() const noexcept
+{
+    return GetSize(mpImpl->mTypes.mArray);
+}
+
+
+void VtuWriter::Write(const std::filesystem::path& rFilePath) const
+{
+    const auto arrays = mpImpl->GetArrays();
+    const auto compressed_data = mpImpl->IsCompressed() ? mpImpl->Compress(arrays) : std::vector<std::vector<char>>();
+    std::size_t appended_offset = 0;
+    std::size_t i_array = 0;
+
+    const auto write_array = [&](std::ostream& rStream, bool IsFieldData) {
+        std::size_t appended_size = 0;
+        if (mpImpl->IsCompressed()) {
+            appended_size = compressed_data[i_array].size();
+        } else if (mpImpl->IsAppended()) {
+            appended_size = sizeof(std::uint64_t) + GetBytes(arrays[i_array]->mArray).second;
+        }
+        mpImpl->WriteArray(rStream, *arrays[i_array++], IsFieldData, &appended_offset, appended_size);
+    };
+
+    std::ofstream file(rFilePath, std::ios::binary);
+    KRATOS_ERROR_IF_NOT(file) << "Failed to open " << rFilePath << " for writing";
+
+    file << "<?xml version=\"1.0\"?>\n"
+         << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\"";
+    if (mpImpl->mFormat == Format::ZLibAppended) {
+        file << " compressor=\"vtkZLibDataCompressor\"";
+    } else if (mpImpl->mFormat == Format::LZ4Appended) {
+        file << " compressor=\"vtkLZ4DataCompressor\"";
+    }
+    file << ">\n"
+         << "<UnstructuredGrid>\n";
+
+    if (!mpImpl->mFieldData.empty()) {
+        file << "<FieldData>\n";
+        for (std::size_t i=0; i<mpImpl->mFieldData.size(); ++i) write_array(file, true);
+        file << "</FieldData>\n";
+    }
+
+    file << "<Piece NumberOfPoints=\"" << this->NumberOfPoints() << "\" NumberOfCells=\"" << this->NumberOfCells() << "\">\n";
+
+    file << "<Points>\n";
+    write_array(file, false);
+    file << "</Points>\n";
+
+    file << "<Cells>\n";
+    for (std::size_t i=0; i<3; ++i) write_array(file, false);
+    file << "</Cells>\n";
+
+    if (!mpImpl->mPointData.empty()) {
+        file << "<PointData>\n";
+        for (std::size_t i=0; i<mpImpl->mPointData.size(); ++i) write_array(file, false);
+        file << "</PointData>\n";
+    }
+
+    if (!mpImpl->mCellData.empty()) {
+        file << "<CellData>\n";
+        for (std::size_t i=0; i<mpImpl->mCellData.size(); ++i) write_array(file, false);
+        file << "</CellData>\n";
+    }
+
+    file << "</Piece>\n"
+         << "</UnstructuredGrid>\n";
+
+    if (mpImpl->IsAppended()) {
+        file << "<AppendedData encoding=\"raw\">\n_";
+        if (mpImpl->IsCompressed()) {
+            for (const auto& r_data : compressed_data) {
+                file.write(r_data.data(), r_data.size());
+            }
+        } else {
+            for (const auto p_array : arrays) {
+                const auto [p_begin, size] = GetBytes(p_array->mArray);
+                const std::uint64_t header = size;
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                file.write(p_begin, size);
+            }
+        }
+        file << "\n</AppendedData>\n";
+    }
+
+    file << "</VTKFile>\n";
+
+    KRATOS_ERROR_IF_NOT(file) << "Failed to write " << rFilePath;
+}
+
+
+void VtuWriter::WriteIndex(const std::filesystem::path& rFilePath,
+                           const std::vector<std::filesystem::path>& rPiecePaths) const
+{
+    const auto write_arrays = [](std::ostream& rStream, const char* pTag, const std::vector<NamedArray>& rArrays) {
+        if (!rArrays.empty()) {
+            rStream << "<" << pTag << ">\n";
+            for (const auto& r_array : rArrays) {
+                std::visit([&rStream, &r_array](const auto& r_values){
+                    using Value = typename std::decay_t<decltype(r_values)>::value_type;
+                    rStream << "<PDataArray type=\"" << GetVtkTypeName<Value>() << "\" "
+                            << "Name=\"" << r_array.mName << "\" "
+                            << "NumberOfComponents=\"" << r_array.mNumberOfComponents << "\"/>\n";
+                }, r_array.mArray);
+            }
+            rStream << "</" << pTag << ">\n";
+        }
+    };
+
+    std::ofstream file(rFilePath);
+    KRATOS_ERROR_IF_NOT(file) << "Failed to open " << rFilePath << " for writing";
+
+    file << "<?xml version=\"1.0\"?>\n"
+         << "<VTKFile type=\"PUnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n"
+         << "<PUnstructuredGrid GhostLevel=\"0\">\n";
+
+    file << "<PPoints>\n"
+         << "<PDataArray type=\"Float64\" Name=\"Points\" NumberOfComponents=\"3\"/>\n"
+         << "</PPoints>\n";
+    write_arrays(file, "PPointData", mpImpl->mPointData);
+    write_arrays(file, "PCellData", mpImpl->mCellData);
+
+    for (const auto& r_piece_path : rPiecePaths) {
+        file << "<Piece Source=\"" << r_piece_path.string() << "\"/>\n";
+    }
+
+    file << "</PUnstructuredGrid>\n"
+         << "</VTKFile>\n";
+
+    KRATOS_ERROR_IF_NOT(file) << "Failed to write " << rFilePath;
+}
+
+
+} // namespace Kratos::Executables
@@ -0,0 +1,54 @@
+#pragma once
+
+// --- STL Includes ---
+#include <array> // std::array
+#include <cstddef> // std::size_t
+
+
+namespace Kratos::Executables {
+
+
+/// @brief Affine transformation of 3D points, stored as a row-major 4x4 matrix.
+/// @details Transformations compose by multiplication, so a chain of operations
+///          can be applied to a set of points in a single pass.
+class AffineTransform
+{
+public:
+    using Matrix = std::array<double,16>;
+
+    /// @brief Construct the identity transformation.
+    AffineTransform() noexcept;
+
+    /// @brief Construct from a row-major 4x4 matrix.
+    /// @details The last row must be (0, 0, 0, 1).
+    explicit AffineTransform(const Matrix& rMatrix);
+
+    static AffineTransform Scale(double Factor) noexcept;
+
+    static AffineTransform Scale(double FactorX, double FactorY, double FactorZ) noexcept;
+
+    static AffineTransform Translation(double X, double Y, double Z) noexcept;
+
+    /// @brief Right-handed rotation around an axis through the origin.
+    /// @param Angle Rotation angle in radians.
+    static AffineTransform Rotation(const std::array<double,3>& rAxis, double Angle);
+
+    /// @brief Reflection across the plane through the origin that is normal to the provided axis.
+    static AffineTransform Mirror(const std::array<double,3>& rNormal);
+
+    /// @brief Compose two transformations.
+    /// @details The result applies @p rRight first, then this transformation.
+    AffineTransform operator*(const AffineTransform& rRight) const noexcept;
+
+    const Matrix& GetMatrix() const noexcept;
+
+    /// @brief Transform points in-place.
+    /// @param pCoordinates Interleaved xyz coordinates of the points.
+    void Apply(double* pCoordinates, std::size_t NumberOfPoints) const;
+
+private:
+    Matrix mMatrix;
+}; // class AffineTransform
+
+
+} // namespace Kratos::Executables
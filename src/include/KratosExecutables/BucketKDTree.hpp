@@ -0,0 +1,96 @@
+#pragma once
+
+// --- STL Includes ---
+#include <vector> // std::vector
+#include <functional> // std::function
+#include <cstddef> // std::size_t
+
+
+namespace Kratos::Executables {
+
+
+/// @brief KD tree over 3D points whose leaves store coordinates in contiguous structure-of-arrays blocks.
+/// @details Radius searches with small leaves spend much of their time computing distances to
+///          the points of the leaves they reach. Leaves of this tree are contiguous ranges of
+///          separate x, y and z arrays, so that distances to all points of a leaf are computed
+///          with AVX2 or AVX-512 instructions, four or eight points at a time. The instruction
+///          set is chosen at runtime, and scalar code runs on CPUs or compilers without them.
+///          Nodes are split at the median of their widest extent, like @ref PartitionedTree.
+class BucketKDTree
+{
+public:
+    /// @brief Implementations of the leaf distance kernel.
+    enum class Kernel
+    {
+        Scalar,
+        AVX2,
+        AVX512
+    };
+
+    /// @param NumberOfPoints Number of points to index.
+    /// @param rGetCoordinate Functor returning coordinate @p iDimension of point @p iPoint,
+    ///                       called as rGetCoordinate(iPoint, iDimension).
+    /// @param LeafSize Maximum number of points in a leaf.
+    /// @param LeafKernel Implementation of the leaf distance kernel, which must be supported (see @ref IsSupported).
+    BucketKDTree(std::size_t NumberOfPoints,
+                 const std::function<double(std::size_t,std::size_t)>& rGetCoordinate,
+                 std::size_t LeafSize,
+                 Kernel LeafKernel = BucketKDTree::GetBestKernel());
+
+    /// @brief Find all points within a radius of a query point.
+    /// @param pPoint Coordinates of the query point.
+    /// @param pResults Output indices of the found points, in the order they were passed to the constructor.
+    /// @param pSquaredDistances Output squared distances of the found points.
+    /// @return Number of found points, at most @p MaxNumberOfResults.
+    std::size_t SearchInRadius(const double* pPoint,
+                               double Radius,
+                               std::size_t* pResults,
+                               double* pSquaredDistances,
+                               std::size_t MaxNumberOfResults) const;
+
+    std::size_t NumberOfPoints() const noexcept;
+
+    Kernel GetKernel() const noexcept;
+
+    /// @brief Check whether this build and the CPU it runs on support a kernel.
+    static bool IsSupported(Kernel LeafKernel) noexcept;
+
+    /// @brief Get the widest supported kernel.
+    static Kernel GetBestKernel() noexcept;
+
+private:
+    struct Node
+    {
+        /// Split dimension, or 3 for leaves.
+        std::size_t mDimension;
+
+        double mValue;
+
+        /// Left child for split nodes, first point for leaves.
+        std::size_t mFirst;
+
+        /// Right child for split nodes, end of the points for leaves.
+        std::size_t mSecond;
+    }; // struct Node
+
+    using KernelFunction = std::size_t(*)(const double*, const double*, const double*, const std::size_t*, std::size_t,
+                                          const double*, double, std::size_t*, double*, std::size_t);
+
+    std::vector<Node> mNodes;
+
+    std::vector<double> mX;
+
+    std::vector<double> mY;
+
+    std::vector<double> mZ;
+
+    /// Indices of the points in leaf order.
+    std::vector<std::size_t> mIndices;
+
+    Kernel mKernel;
+
+    KernelFunction mpKernel;
+}; // class BucketKDTree
+
+
+} // namespace Kratos::Executables
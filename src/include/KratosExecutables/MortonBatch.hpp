@@ -0,0 +1,143 @@
+#pragma once
+
+// --- Core Includes ---
+#include "utilities/parallel_utilities.h" // IndexPartition
+
+// --- Internal Includes ---
+#include "KratosExecutables/ParallelSort.hpp" // ParallelSort
+
+// --- STL Includes ---
+#include <vector> // std::vector
+#include <array> // std::array
+#include <utility> // std::pair
+#include <cstdint> // std::uint64_t
+#include <algorithm> // std::min, std::max
+#include <limits> // std::numeric_limits
+
+
+namespace Kratos::Executables {
+
+
+/// @brief Batch of spatial queries that runs in Morton (Z-order) order.
+/// @details Queries in the input order (e.g.: mesh IDs) generally jump between unrelated
+///          branches of a search tree, while queries that are close in space visit the same
+///          branches, which then stay in cache. The query points are quantized to 63 / TDimension
+///          bits per dimension within their bounding box and sorted by their interleaved bits.
+///          Blocks of consecutive queries in this order are distributed across threads, and each
+///          query receives its index in the input, so that results land in the input order.
+/// @tparam TDimension Number of coordinates of the query points.
+template <std::size_t TDimension = 3>
+class MortonBatch
+{
+public:
+    static_assert(0 < TDimension && TDimension <= 3, "Morton keys support up to 3 dimensions");
+
+    /// @param NumberOfQueries Number of query points.
+    /// @param rGetCoordinate Functor returning coordinate @p iDimension of query @p iQuery,
+    ///                       called as rGetCoordinate(iQuery, iDimension).
+    template <class TGetCoordinate>
+    MortonBatch(std::size_t NumberOfQueries, TGetCoordinate&& rGetCoordinate)
+        : mOrder(NumberOfQueries)
+    {
+        std::array<double,TDimension> min, max;
+        min.fill(std::numeric_limits<double>::max());
+        max.fill(std::numeric_limits<double>::lowest());
+        for (std::size_t i_query = 0; i_query < NumberOfQueries; ++i_query) {
+            for (std::size_t i_dimension = 0; i_dimension < TDimension; ++i_dimension) {
+                const double coordinate = rGetCoordinate(i_query, i_dimension);
+                min[i_dimension] = std::min(min[i_dimension], coordinate);
+                max[i_dimension] = std::max(max[i_dimension], coordinate);
+            }
+        }
+
+        std::array<double,TDimension> scale;
+        for (std::size_t i_dimension = 0; i_dimension < TDimension; ++i_dimension) {
+            const double extent = max[i_dimension] - min[i_dimension];
+            scale[i_dimension] = 0 < extent ? MaxCell / extent : 0.0;
+        }
+
+        std::vector<std::pair<std::uint64_t,std::size_t>> keys(NumberOfQueries);
+        IndexPartition<std::size_t>(NumberOfQueries).for_each([&keys, &rGetCoordinate, &min, &scale](std::size_t Index) {
+            std::uint64_t key = 0;
+            for (std::size_t i_dimension = 0; i_dimension < TDimension; ++i_dimension) {
+                const double cell = (rGetCoordinate(Index, i_dimension) - min[i_dimension]) * scale[i_dimension];
+                key |= MortonBatch::SpreadBits(static_cast<std::uint64_t>(std::min(cell, static_cast<double>(MaxCell)))) << i_dimension;
+            }
+            keys[Index] = {key, Index};
+        });
+
+        ParallelSort(keys.begin(), keys.end());
+        IndexPartition<std::size_t>(NumberOfQueries).for_each([this, &keys](std::size_t Index) {
+            mOrder[Index] = keys[Index].second;
+        });
+    }
+
+    /// @brief Indices of the queries in Morton order.
+    const std::vector<std::size_t>& GetOrder() const noexcept
+    {
+        return mOrder;
+    }
+
+    /// @brief Run all queries in parallel, in blocks of consecutive queries in Morton order.
+    /// @param BlockSize Number of queries per block, or 0 for one block per thread.
+    /// @param rFunction Called as rFunction(iQuery, rTLS) with the index of the query in the input.
+    template <class TTLS, class TFunction>
+    void ForEach(std::size_t BlockSize, const TTLS& rTLS, TFunction&& rFunction) const
+    {
+        IndexPartition<std::size_t>(mOrder.size(), this->GetNumberOfBlocks(BlockSize)).for_each(rTLS, [this, &rFunction](std::size_t Index, TTLS& rLocal) {
+            rFunction(mOrder[Index], rLocal);
+        });
+    }
+
+    /// @brief Run all queries in parallel and reduce their return values.
+    /// @see ForEach
+    template <class TReducer, class TTLS, class TFunction>
+    auto ForEach(std::size_t BlockSize, const TTLS& rTLS, TFunction&& rFunction) const
+    {
+        return IndexPartition<std::size_t>(mOrder.size(), this->GetNumberOfBlocks(BlockSize)).template for_each<TReducer>(rTLS, [this, &rFunction](std::size_t Index, TTLS& rLocal) {
+            return rFunction(mOrder[Index], rLocal);
+        });
+    }
+
+private:
+    static constexpr std::size_t BitsPerDimension = 63 / TDimension;
+
+    static constexpr std::uint64_t MaxCell = (std::uint64_t(1) << BitsPerDimension) - 1;
+
+    /// @brief Insert TDimension - 1 zero bits between consecutive bits of @p Value.
+    static std::uint64_t SpreadBits(std::uint64_t Value) noexcept
+    {
+        if constexpr (TDimension == 1) {
+            return Value;
+        } else if constexpr (TDimension == 2) {
+            Value &= 0x00000000ffffffffull;
+            Value = (Value | (Value << 16)) & 0x0000ffff0000ffffull;
+            Value = (Value | (Value << 8)) & 0x00ff00ff00ff00ffull;
+            Value = (Value | (Value << 4)) & 0x0f0f0f0f0f0f0f0full;
+            Value = (Value | (Value << 2)) & 0x3333333333333333ull;
+            Value = (Value | (Value << 1)) & 0x5555555555555555ull;
+            return Value;
+        } else {
+            Value &= 0x00000000001fffffull;
+            Value = (Value | (Value << 32)) & 0x001f00000000ffffull;
+            Value = (Value | (Value << 16)) & 0x001f0000ff0000ffull;
+            Value = (Value | (Value << 8)) & 0x100f00f00f00f00full;
+            Value = (Value | (Value << 4)) & 0x10c30c30c30c30c3ull;
+            Value = (Value | (Value << 2)) & 0x1249249249249249ull;
+            return Value;
+        }
+    }
+
+    std::size_t GetNumberOfBlocks(std::size_t BlockSize) const noexcept
+    {
+        const std::size_t number_of_blocks = BlockSize
+            ? (mOrder.size() + BlockSize - 1) / BlockSize
+            : ParallelUtilities::GetNumThreads();
+        return std::max<std::size_t>(1, std::min(number_of_blocks, mOrder.size()));
+    }
+
+    std::vector<std::size_t> mOrder;
+}; // class MortonBatch
+
+
+} // namespace Kratos::Executables
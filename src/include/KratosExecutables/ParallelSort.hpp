@@ -0,0 +1,41 @@
+#pragma once
+
+// --- Core Includes ---
+#include "utilities/parallel_utilities.h" // IndexPartition, ParallelUtilities
+
+// --- STL Includes ---
+#include <algorithm> // std::sort, std::inplace_merge, std::min, std::max
+#include <functional> // std::less
+#include <iterator> // std::distance
+
+
+namespace Kratos::Executables {
+
+
+/// @brief Sort a random access range on the threads of @p ParallelUtilities.
+/// @details The range is split into one chunk per thread, which are sorted in parallel. Pairs of
+///          neighbouring chunks are then merged level by level, with the merges of each level in
+///          parallel. The order of equivalent elements is unspecified, like with std::sort.
+template <class TIterator, class TComparison = std::less<>>
+void ParallelSort(TIterator Begin, TIterator End, TComparison Comparison = {})
+{
+    const std::size_t size = std::distance(Begin, End);
+    const std::size_t number_of_chunks = std::max<std::size_t>(1, std::min<std::size_t>(ParallelUtilities::GetNumThreads(), size));
+    const std::size_t chunk_size = (size + number_of_chunks - 1) / number_of_chunks;
+    const auto get_bound = [Begin, size](std::size_t Offset) {return Begin + static_cast<std::ptrdiff_t>(std::min(Offset, size));};
+
+    IndexPartition<std::size_t>(number_of_chunks).for_each([&](std::size_t Index) {
+        std::sort(get_bound(Index * chunk_size), get_bound((Index + 1) * chunk_size), Comparison);
+    });
+
+    for (std::size_t width = chunk_size; width < size; width *= 2) {
+        const std::size_t number_of_merges = (size + 2 * width - 1) / (2 * width);
+        IndexPartition<std::size_t>(number_of_merges).for_each([&](std::size_t Index) {
+            const std::size_t offset = 2 * width * Index;
+            std::inplace_merge(get_bound(offset), get_bound(offset + width), get_bound(offset + 2 * width), Comparison);
+        });
+    }
+}
+
+
+} // namespace Kratos::Executables
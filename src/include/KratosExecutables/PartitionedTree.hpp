@@ -0,0 +1,311 @@
+#pragma once
+
+// --- Core Includes ---
+#include "utilities/parallel_utilities.h" // IndexPartition, ParallelUtilities
+
+// --- STL Includes ---
+#include <vector> // std::vector
+#include <array> // std::array
+#include <memory> // std::unique_ptr
+#include <iterator> // std::iterator_traits, std::distance
+#include <limits> // std::numeric_limits
+#include <algorithm> // std::nth_element, std::minmax_element, std::partition, std::move, std::min, std::max
+
+
+namespace Kratos::Executables {
+
+
+/// @brief Spatial search tree that is constructed in parallel from independent subtrees.
+/// @details The points are split at the median of their widest extent, level by level, until
+///          the requested number of partitions is reached. Levels with at least as many ranges as
+///          threads split their ranges in parallel. Levels with fewer ranges split them one after
+///          the other, each with all threads: the bounds are reduced over chunks in parallel, and
+///          the range is partitioned in parallel around the median of an evenly spaced sample,
+///          through a buffer as large as the range. A separate @p TTree is then constructed for
+///          each partition in parallel. Queries descend the split planes and only visit subtrees
+///          the search ball reaches.
+/// @tparam TTree Spatial search tree with the interface of @p Kratos::Tree (e.g.: KDTreePartition of Buckets).
+template <class TTree, std::size_t TDimension = 3>
+class PartitionedTree
+{
+public:
+    using PointType = typename TTree::PointType;
+
+    using PointerType = typename TTree::PointerType;
+
+    using IteratorType = typename TTree::IteratorType;
+
+    using DistanceIteratorType = typename TTree::DistanceIteratorType;
+
+    using SizeType = typename TTree::SizeType;
+
+    using CoordinateType = typename TTree::CoordinateType;
+
+    /// @param NumberOfPartitions Number of subtrees, rounded up to a power of 2.
+    ///                           Partitions are not split below @p BucketSize points.
+    PartitionedTree(IteratorType Begin,
+                    IteratorType End,
+                    SizeType BucketSize,
+                    SizeType NumberOfPartitions)
+    {
+        mNodes.push_back(Node {0, 0.0, 0, 0, 0});
+        std::vector<Range> leaves {Range {Begin, End, 0}};
+
+        const std::size_t number_of_threads = std::max(1, ParallelUtilities::GetNumThreads());
+        while (leaves.size() < NumberOfPartitions) {
+            std::vector<Split> splits(leaves.size());
+            if (leaves.size() < number_of_threads) {
+                for (std::size_t i_leaf = 0; i_leaf < leaves.size(); ++i_leaf) {
+                    splits[i_leaf] = PartitionedTree::SplitRange(leaves[i_leaf], BucketSize, number_of_threads);
+                }
+            } else {
+                IndexPartition<std::size_t>(leaves.size()).for_each([&leaves, &splits, BucketSize](std::size_t Index) {
+                    splits[Index] = PartitionedTree::SplitRange(leaves[Index], BucketSize, 1);
+                });
+            }
+
+            std::vector<Range> next;
+            for (std::size_t i_leaf = 0; i_leaf < leaves.size(); ++i_leaf) {
+                const Range& r_leaf = leaves[i_leaf];
+                const Split& r_split = splits[i_leaf];
+                if (!r_split.mIsSplit) {
+                    next.push_back(r_leaf);
+                    continue;
+                }
+
+                const std::size_t i_left = mNodes.size();
+                const std::size_t i_right = i_left + 1;
+                mNodes.push_back(Node {0, 0.0, 0, 0, 0});
+                mNodes.push_back(Node {0, 0.0, 0, 0, 0});
+                mNodes[r_leaf.mNode] = Node {r_split.mDimension, r_split.mValue, i_left, i_right, 0};
+                next.push_back(Range {r_leaf.mBegin, r_split.mMiddle, i_left});
+                next.push_back(Range {r_split.mMiddle, r_leaf.mEnd, i_right});
+            }
+
+            if (next.size() == leaves.size()) break;
+            leaves.swap(next);
+        }
+
+        mTrees.resize(leaves.size());
+        IndexPartition<std::size_t>(leaves.size()).for_each([this, &leaves, BucketSize](std::size_t Index) {
+            mTrees[Index] = std::make_unique<TTree>(leaves[Index].mBegin, leaves[Index].mEnd, BucketSize);
+        });
+        for (std::size_t i_leaf = 0; i_leaf < leaves.size(); ++i_leaf) {
+            mNodes[leaves[i_leaf].mNode].mTree = i_leaf + 1;
+        }
+    }
+
+    SizeType NumberOfPartitions() const noexcept
+    {
+        return mTrees.size();
+    }
+
+    SizeType SearchInRadius(const PointType& rPoint,
+                            CoordinateType Radius,
+                            IteratorType Results,
+                            DistanceIteratorType ResultDistances,
+                            SizeType MaxNumberOfResults)
+    {
+        SizeType number_of_results = 0;
+        this->SearchInRadius(0, rPoint, Radius, Results, ResultDistances, MaxNumberOfResults, number_of_results);
+        return number_of_results;
+    }
+
+private:
+    struct Node
+    {
+        std::size_t mDimension;
+
+        CoordinateType mValue;
+
+        std::size_t mLeft;
+
+        std::size_t mRight;
+
+        /// Index of the subtree + 1 for leaves, 0 for split nodes.
+        std::size_t mTree;
+    }; // struct Node
+
+    struct Range
+    {
+        IteratorType mBegin;
+
+        IteratorType mEnd;
+
+        std::size_t mNode;
+    }; // struct Range
+
+    struct Split
+    {
+        bool mIsSplit;
+
+        std::size_t mDimension;
+
+        CoordinateType mValue;
+
+        IteratorType mMiddle;
+    }; // struct Split
+
+    using Bounds = std::array<std::array<CoordinateType,2>,TDimension>;
+
+    /// @brief Reorder a range around the median of its widest extent.
+    /// @param NumberOfChunks Number of chunks processed in parallel, or 1 to split serially with an exact median.
+    static Split SplitRange(const Range& rRange, SizeType BucketSize, std::size_t NumberOfChunks)
+    {
+        const auto size = std::distance(rRange.mBegin, rRange.mEnd);
+        if (size < 2 * static_cast<std::ptrdiff_t>(std::max<SizeType>(BucketSize, 1))) {
+            return Split {false, 0, 0.0, rRange.mEnd};
+        }
+
+        const std::size_t number_of_chunks = std::min<std::size_t>(NumberOfChunks, size);
+        const std::size_t dimension = number_of_chunks < 2
+                                    ? GetWidestDimension(rRange.mBegin, rRange.mEnd)
+                                    : GetWidestDimension(rRange.mBegin, rRange.mEnd, number_of_chunks);
+        const auto is_less = [dimension](const auto& rpLeft, const auto& rpRight) {
+            return (*rpLeft)[dimension] < (*rpRight)[dimension];
+        };
+
+        if (1 < number_of_chunks) {
+            // Approximate median of an evenly spaced sample.
+            const std::ptrdiff_t sample_size = std::min<std::ptrdiff_t>(size, 4096);
+            std::vector<CoordinateType> sample(sample_size);
+            for (std::ptrdiff_t i_sample = 0; i_sample < sample_size; ++i_sample) {
+                sample[i_sample] = (**(rRange.mBegin + i_sample * size / sample_size))[dimension];
+            }
+            std::nth_element(sample.begin(), sample.begin() + sample_size / 2, sample.end());
+            const CoordinateType value = sample[sample_size / 2];
+
+            const auto it_middle = ParallelPartition(rRange.mBegin, rRange.mEnd, number_of_chunks, [dimension, value](const auto& rpPoint) {
+                return (*rpPoint)[dimension] < value;
+            });
+
+            // Many points equal to the sample median may leave one side empty.
+            if (it_middle != rRange.mBegin && it_middle != rRange.mEnd) {
+                return Split {true, dimension, value, it_middle};
+            }
+        }
+
+        const auto it_middle = rRange.mBegin + size / 2;
+        std::nth_element(rRange.mBegin, it_middle, rRange.mEnd, is_less);
+        return Split {true, dimension, (**it_middle)[dimension], it_middle};
+    }
+
+    static std::size_t GetWidestDimension(IteratorType Begin, IteratorType End)
+    {
+        std::size_t output = 0;
+        CoordinateType widest = -1;
+        for (std::size_t i_dimension = 0; i_dimension < TDimension; ++i_dimension) {
+            const auto [it_min, it_max] = std::minmax_element(Begin, End, [i_dimension](const auto& rpLeft, const auto& rpRight) {
+                return (*rpLeft)[i_dimension] < (*rpRight)[i_dimension];
+            });
+            const CoordinateType extent = (**it_max)[i_dimension] - (**it_min)[i_dimension];
+            if (widest < extent) {
+                widest = extent;
+                output = i_dimension;
+            }
+        }
+        return output;
+    }
+
+    /// @brief Find the widest dimension from bounds reduced over chunks in parallel.
+    static std::size_t GetWidestDimension(IteratorType Begin, IteratorType End, std::size_t NumberOfChunks)
+    {
+        const std::size_t size = std::distance(Begin, End);
+        std::vector<Bounds> chunk_bounds(NumberOfChunks);
+        IndexPartition<std::size_t>(NumberOfChunks).for_each([&](std::size_t Index) {
+            Bounds& r_bounds = chunk_bounds[Index];
+            for (auto& r_bound : r_bounds) r_bound = {std::numeric_limits<CoordinateType>::max(), std::numeric_limits<CoordinateType>::lowest()};
+            for (auto it = Begin + Index * size / NumberOfChunks; it != Begin + (Index + 1) * size / NumberOfChunks; ++it) {
+                for (std::size_t i_dimension = 0; i_dimension < TDimension; ++i_dimension) {
+                    r_bounds[i_dimension][0] = std::min(r_bounds[i_dimension][0], (**it)[i_dimension]);
+                    r_bounds[i_dimension][1] = std::max(r_bounds[i_dimension][1], (**it)[i_dimension]);
+                }
+            }
+        });
+
+        std::size_t output = 0;
+        CoordinateType widest = -1;
+        for (std::size_t i_dimension = 0; i_dimension < TDimension; ++i_dimension) {
+            CoordinateType min = std::numeric_limits<CoordinateType>::max();
+            CoordinateType max = std::numeric_limits<CoordinateType>::lowest();
+            for (const Bounds& r_bounds : chunk_bounds) {
+                min = std::min(min, r_bounds[i_dimension][0]);
+                max = std::max(max, r_bounds[i_dimension][1]);
+            }
+            if (widest < max - min) {
+                widest = max - min;
+                output = i_dimension;
+            }
+        }
+        return output;
+    }
+
+    /// @brief Partition each chunk in parallel, then gather the sides of all chunks through a buffer.
+    template <class TPredicate>
+    static IteratorType ParallelPartition(IteratorType Begin, IteratorType End, std::size_t NumberOfChunks, TPredicate&& rPredicate)
+    {
+        const std::size_t size = std::distance(Begin, End);
+        const auto get_bound = [Begin, size, NumberOfChunks](std::size_t Index) {return Begin + Index * size / NumberOfChunks;};
+
+        std::vector<IteratorType> chunk_middles(NumberOfChunks);
+        IndexPartition<std::size_t>(NumberOfChunks).for_each([&](std::size_t Index) {
+            chunk_middles[Index] = std::partition(get_bound(Index), get_bound(Index + 1), rPredicate);
+        });
+
+        // Offsets of each chunk's sides in the output.
+        std::vector<std::size_t> left_offsets(NumberOfChunks + 1, 0), right_offsets(NumberOfChunks + 1, 0);
+        for (std::size_t i_chunk = 0; i_chunk < NumberOfChunks; ++i_chunk) {
+            left_offsets[i_chunk + 1] = left_offsets[i_chunk] + std::distance(get_bound(i_chunk), chunk_middles[i_chunk]);
+            right_offsets[i_chunk + 1] = right_offsets[i_chunk] + std::distance(chunk_middles[i_chunk], get_bound(i_chunk + 1));
+        }
+        const std::size_t number_of_left = left_offsets.back();
+
+        std::vector<typename std::iterator_traits<IteratorType>::value_type> buffer(size);
+        IndexPartition<std::size_t>(NumberOfChunks).for_each([&](std::size_t Index) {
+            std::move(get_bound(Index), chunk_middles[Index], buffer.begin() + left_offsets[Index]);
+            std::move(chunk_middles[Index], get_bound(Index + 1), buffer.begin() + number_of_left + right_offsets[Index]);
+        });
+        IndexPartition<std::size_t>(NumberOfChunks).for_each([&](std::size_t Index) {
+            std::move(buffer.begin() + Index * size / NumberOfChunks, buffer.begin() + (Index + 1) * size / NumberOfChunks, get_bound(Index));
+        });
+
+        return Begin + number_of_left;
+    }
+
+    void SearchInRadius(std::size_t iNode,
+                        const PointType& rPoint,
+                        CoordinateType Radius,
+                        IteratorType& rResults,
+                        DistanceIteratorType& rResultDistances,
+                        SizeType MaxNumberOfResults,
+                        SizeType& rNumberOfResults)
+    {
+        const Node& r_node = mNodes[iNode];
+        if (r_node.mTree) {
+            auto& rp_tree = mTrees[r_node.mTree - 1];
+            if (rNumberOfResults < MaxNumberOfResults) {
+                const SizeType count = rp_tree->SearchInRadius(rPoint, Radius, rResults, rResultDistances, MaxNumberOfResults - rNumberOfResults);
+                rResults += count;
+                rResultDistances += count;
+                rNumberOfResults += count;
+            }
+            return;
+        }
+
+        // Points equal to the split value may be on either side.
+        const CoordinateType offset = rPoint[r_node.mDimension] - r_node.mValue;
+        if (offset <= Radius) {
+            this->SearchInRadius(r_node.mLeft, rPoint, Radius, rResults, rResultDistances, MaxNumberOfResults, rNumberOfResults);
+        }
+        if (-Radius <= offset) {
+            this->SearchInRadius(r_node.mRight, rPoint, Radius, rResults, rResultDistances, MaxNumberOfResults, rNumberOfResults);
+        }
+    }
+
+    std::vector<Node> mNodes;
+
+    std::vector<std::unique_ptr<TTree>> mTrees;
+}; // class PartitionedTree
+
+
+} // namespace Kratos::Executables
@@ -0,0 +1,47 @@
+#pragma once
+
+// --- STL Includes ---
+#include <memory> // std::unique_ptr
+#include <string> // std::string
+#include <vector> // std::vector
+#include <utility> // std::pair
+
+
+namespace Kratos::Executables {
+
+
+/// @brief Hardware performance counters of the current process, through Linux' perf_event_open.
+/// @details Counts cycles, instructions, branch misses, L1 data cache read misses and last level
+///          cache read misses in user space, over all threads of the process: threads that exist
+///          at construction are opened one by one, and threads they create later are inherited.
+///          Events the CPU, kernel or permissions (see /proc/sys/kernel/perf_event_paranoid)
+///          do not provide are skipped, so the set of counters may be empty (e.g.: in virtual
+///          machines or on other platforms). Counts are scaled when the kernel multiplexes events.
+class PerformanceCounters
+{
+public:
+    PerformanceCounters();
+
+    PerformanceCounters(PerformanceCounters&&) noexcept;
+
+    ~PerformanceCounters();
+
+    /// @brief Check whether any of the events could be opened.
+    bool IsAvailable() const noexcept;
+
+    /// @brief Get the names of the events that could not be opened, and the reasons.
+    const std::vector<std::pair<std::string,std::string>>& GetUnavailableEvents() const noexcept;
+
+    /// @brief Begin a measurement.
+    void Start();
+
+    /// @brief Get the counts of each available event since the last call to @ref Start.
+    std::vector<std::pair<std::string,double>> Read() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> mpImpl;
+}; // class PerformanceCounters
+
+
+} // namespace Kratos::Executables
@@ -0,0 +1,158 @@
+#pragma once
+
+// --- STL Includes ---
+#include <vector> // std::vector
+#include <limits> // std::numeric_limits
+#include <cstddef> // std::size_t
+
+
+namespace Kratos::Executables {
+
+
+/// @brief Fixed capacity output of spatial searches, reused across queries without allocating.
+/// @details Storage is allocated once at construction (e.g.: once per thread), and each query
+///          overwrites the results of the previous one. Results beyond the capacity are dropped
+///          and flagged instead of reallocating. The buffer is a nanoflann result set for radius
+///          searches (see radiusSearchCustomCallback), which stops the search once it is full.
+///          Searches writing through output iterators, like @p Kratos::Tree::SearchInRadius,
+///          fill @ref ValuesBegin and @ref DistancesBegin directly and report their count
+///          through @ref SetSize.
+/// @tparam TValue Type of the results (e.g.: indices for nanoflann, pointers for Kratos).
+/// @note Results are not sorted, regardless of nanoflann's SearchParameters::sorted.
+template <class TValue, class TDistance = double>
+class SearchResultBuffer
+{
+public:
+    using IndexType = TValue;
+
+    using DistanceType = TDistance;
+
+    using ValueIterator = typename std::vector<TValue>::iterator;
+
+    using DistanceIterator = typename std::vector<TDistance>::iterator;
+
+    /// @param Radius Search radius of nanoflann searches, which is squared for L2 metrics.
+    explicit SearchResultBuffer(std::size_t Capacity, TDistance Radius = std::numeric_limits<TDistance>::max())
+        : mValues(Capacity),
+          mDistances(Capacity),
+          mRadius(Radius)
+    {
+    }
+
+    std::size_t Capacity() const noexcept
+    {
+        return mValues.size();
+    }
+
+    /// @brief Whether the last query found more results than fit in the buffer.
+    bool IsTruncated() const noexcept
+    {
+        return mIsTruncated;
+    }
+
+    const TValue& GetValue(std::size_t Index) const noexcept
+    {
+        return mValues[Index];
+    }
+
+    TDistance GetDistance(std::size_t Index) const noexcept
+    {
+        return mDistances[Index];
+    }
+
+    void SetRadius(TDistance Radius) noexcept
+    {
+        mRadius = Radius;
+    }
+
+    /// @name Output iterator interface
+    /// @{
+
+    ValueIterator ValuesBegin() noexcept
+    {
+        return mValues.begin();
+    }
+
+    DistanceIterator DistancesBegin() noexcept
+    {
+        return mDistances.begin();
+    }
+
+    /// @brief Set the number of results written through the iterators.
+    /// @details A search that filled the whole buffer may have found more results.
+    void SetSize(std::size_t Size) noexcept
+    {
+        mSize = Size;
+        mIsTruncated = Size == this->Capacity();
+    }
+
+    /// @}
+    /// @name nanoflann result set interface
+    /// @{
+
+    void init() noexcept
+    {
+        this->clear();
+    }
+
+    void clear() noexcept
+    {
+        mSize = 0;
+        mIsTruncated = false;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return mSize;
+    }
+
+    bool empty() const noexcept
+    {
+        return !mSize;
+    }
+
+    bool full() const noexcept
+    {
+        return true;
+    }
+
+    /// @return False if the buffer is full, which ends the search.
+    bool addPoint(TDistance Distance, TValue Value) noexcept
+    {
+        if (Distance < mRadius) {
+            if (mSize == this->Capacity()) {
+                mIsTruncated = true;
+                return false;
+            }
+            mValues[mSize] = Value;
+            mDistances[mSize] = Distance;
+            ++mSize;
+        }
+        return true;
+    }
+
+    TDistance worstDist() const noexcept
+    {
+        return mRadius;
+    }
+
+    void sort() noexcept
+    {
+    }
+
+    /// @}
+
+private:
+    std::vector<TValue> mValues;
+
+    std::vector<TDistance> mDistances;
+
+    TDistance mRadius;
+
+    std::size_t mSize = 0;
+
+    bool mIsTruncated = false;
+}; // class SearchResultBuffer
+
+
+} // namespace Kratos::Executables
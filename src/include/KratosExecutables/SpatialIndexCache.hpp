@@ -0,0 +1,114 @@
+#pragma once
+
+// --- STL Includes ---
+#include <filesystem> // std::filesystem::path
+#include <memory> // std::unique_ptr
+#include <streambuf> // std::streambuf
+#include <istream> // std::istream
+#include <ostream> // std::ostream
+#include <functional> // std::function
+#include <string> // std::string
+#include <cstdint> // std::uint64_t
+#include <cstddef> // std::size_t
+
+
+namespace Kratos::Executables {
+
+
+/// @brief Incremental hash of point coordinates, used to identify the points an index was built for.
+/// @details Hashes the bit patterns of the coordinates, so the result depends on their order.
+class CoordinateHash
+{
+public:
+    void Add(double Value) noexcept;
+
+    void Add(std::uint64_t Value) noexcept;
+
+    std::uint64_t Get() const noexcept;
+
+private:
+    std::uint64_t mHash = 0xcbf29ce484222325ull;
+}; // class CoordinateHash
+
+
+/// @brief Read-only memory mapped file.
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::filesystem::path& rFilePath);
+
+    MappedFile(MappedFile&&) noexcept;
+
+    ~MappedFile();
+
+    const char* Data() const noexcept;
+
+    std::size_t Size() const noexcept;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> mpImpl;
+}; // class MappedFile
+
+
+/// @brief Input stream buffer over a contiguous range of memory, without copying it.
+class MemoryStreamBuffer final : public std::streambuf
+{
+public:
+    MemoryStreamBuffer(const char* pBegin, std::size_t Size);
+
+protected:
+    pos_type seekoff(off_type Offset, std::ios_base::seekdir Direction, std::ios_base::openmode Mode) override;
+
+    pos_type seekpos(pos_type Position, std::ios_base::openmode Mode) override;
+}; // class MemoryStreamBuffer
+
+
+/// @brief Cache of serialized spatial search indices.
+/// @details Each index is stored in a separate file named after a prefix and a key, which
+///          should hash the coordinates and the index parameters (see @ref CoordinateHash).
+///          Files begin with a header repeating the key and the size of the index, so that
+///          stale, foreign or truncated files are rebuilt instead of loaded. Files are written under a temporary name and renamed,
+///          so concurrent jobs never read partially written indices.
+///          Indices are read from memory mapped files, which avoids copying them into stream
+///          buffers and reuses the page cache across jobs.
+class SpatialIndexCache
+{
+public:
+    /// @param rDirectory Directory of the cache files (e.g.: the directory of the mesh).
+    /// @param rPrefix Prefix of the cache files (e.g.: the name of the mesh).
+    SpatialIndexCache(const std::filesystem::path& rDirectory, const std::string& rPrefix);
+
+    std::filesystem::path GetPath(std::uint64_t Key) const;
+
+    /// @brief Load a cached index.
+    /// @param rLoad Functor deserializing the index from a stream (e.g.: nanoflann's loadIndex).
+    /// @return False if no valid cache file exists for @p Key.
+    bool Load(std::uint64_t Key, const std::function<void(std::istream&)>& rLoad) const;
+
+    /// @brief Write an index to the cache.
+    /// @param rSave Functor serializing the index to a stream (e.g.: nanoflann's saveIndex).
+    void Store(std::uint64_t Key, const std::function<void(std::ostream&)>& rSave) const;
+
+    /// @brief Load an index from the cache, or build and store it if it is not cached.
+    /// @tparam TIndex Index with the serialization interface of nanoflann (buildIndex, saveIndex, loadIndex).
+    /// @return True if the index was loaded from the cache.
+    template <class TIndex>
+    bool LoadOrBuild(TIndex& rIndex, std::uint64_t Key) const
+    {
+        if (this->Load(Key, [&rIndex](std::istream& rStream) {rIndex.loadIndex(rStream);})) {
+            return true;
+        }
+        rIndex.buildIndex();
+        this->Store(Key, [&rIndex](std::ostream& rStream) {rIndex.saveIndex(rStream);});
+        return false;
+    }
+
+private:
+    std::filesystem::path mDirectory;
+
+    std::string mPrefix;
+}; // class SpatialIndexCache
+
+
+} // namespace Kratos::Executables
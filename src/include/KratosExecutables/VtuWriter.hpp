@@ -0,0 +1,89 @@
+#pragma once
+
+// --- STL Includes ---
+#include <cstdint> // std::uint8_t, std::int32_t, std::int64_t
+#include <filesystem> // std::filesystem::path
+#include <memory> // std::unique_ptr
+#include <string> // std::string
+#include <variant> // std::variant
+#include <vector> // std::vector
+
+
+namespace Kratos::Executables {
+
+
+/// @brief Writer for VTK XML unstructured grids (*.vtu).
+/// @details Unlike @p Kratos::VtuOutput, this writer is not bound to a @p ModelPart.
+///          Points, cells and data arrays are provided as flat arrays, which lets
+///          the caller decide what gets written and with which integer width.
+class VtuWriter
+{
+public:
+    using DataArray = std::variant<
+        std::vector<std::uint8_t>,
+        std::vector<std::int32_t>,
+        std::vector<std::int64_t>,
+        std::vector<double>
+    >;
+
+    enum class Format
+    {
+        ASCII,
+        Binary,         //< base64 encoded inline data.
+        RawAppended,    //< raw binary data appended after the XML.
+        ZLibAppended,   //< zlib compressed binary data appended after the XML.
+        LZ4Appended     //< lz4 compressed binary data appended after the XML.
+    }; // enum class Format
+
+    explicit VtuWriter(Format OutputFormat = Format::Binary);
+
+    VtuWriter(VtuWriter&& rOther) noexcept;
+
+    VtuWriter& operator=(VtuWriter&& rOther) noexcept;
+
+    ~VtuWriter();
+
+    /// @brief Set point coordinates as a flat array of xyz triplets.
+    void SetPoints(std::vector<double>&& rCoordinates);
+
+    /// @brief Set cells in VTK's connectivity-offsets-types layout.
+    /// @param rConnectivity Concatenated point indices of all cells.
+    /// @param rOffsets End position of each cell in @p rConnectivity.
+    /// @param rTypes VTK cell type of each cell.
+    void SetCells(std::vector<std::int64_t>&& rConnectivity,
+                  std::vector<std::int64_t>&& rOffsets,
+                  std::vector<std::uint8_t>&& rTypes);
+
+    void AddPointData(const std::string& rName,
+                      DataArray&& rArray,
+                      std::size_t NumberOfComponents = 1);
+
+    void AddCellData(const std::string& rName,
+                     DataArray&& rArray,
+                     std::size_t NumberOfComponents = 1);
+
+    /// @brief Add an array that is not associated with points or cells.
+    /// @details Field data may have an arbitrary number of tuples.
+    void AddFieldData(const std::string& rName,
+                      DataArray&& rArray);
+
+    std::size_t NumberOfPoints() const noexcept;
+
+    std::size_t NumberOfCells() const noexcept;
+
+    void Write(const std::filesystem::path& rFilePath) const;
+
+    /// @brief Write a parallel unstructured grid index (*.pvtu) that refers to a set of pieces.
+    /// @details The pieces are expected to have the same point and cell arrays as this writer.
+    ///          Field data is not part of the index.
+    /// @param rPiecePaths Paths to the pieces, relative to the index file's directory.
+    void WriteIndex(const std::filesystem::path& rFilePath,
+                    const std::vector<std::filesystem::path>& rPiecePaths) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> mpImpl;
+}; // class VtuWriter
+
+
+} // namespace Kratos::Executables